@@ -0,0 +1,346 @@
+// bench/bench_rbtree.c
+#define _POSIX_C_SOURCE 199309L
+
+#include "../include/rb_packed.h"
+#include "../include/rb_tree.h"
+#include "../include/rb_tree_inline.h"
+#include "../include/rb_tree_td.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_N 1000000
+
+/**
+ * @brief Monotonic wall clock in seconds.
+ */
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Small xorshift PRNG so runs are reproducible across libcs.
+ */
+static unsigned int rng_state = 2463534242u;
+static unsigned int rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/**
+ * @brief Fill keys[] with 0..n-1, shuffled if requested.
+ */
+static void make_keys(int *keys, size_t n, int shuffle) {
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = (int)i;
+    }
+    if (!shuffle) {
+        return;
+    }
+    for (size_t i = n - 1; i > 0; i--) {
+        size_t j = rng_next() % (i + 1);
+        int tmp = keys[i];
+        keys[i] = keys[j];
+        keys[j] = tmp;
+    }
+}
+
+/**
+ * @brief Print one result row in nanoseconds per operation.
+ */
+static void report(const char *name, const char *op, size_t n, double sec) {
+    printf("  %-10s %-8s %8.1f ns/op\n", name, op, sec * 1e9 / (double)n);
+}
+
+/**
+ * @brief Bottom-up (parent pointer) tree: insert, search, delete.
+ */
+static void bench_bottom_up(const int *keys, size_t n) {
+    RBTree *t = rb_tree_create();
+    if (!t) {
+        fprintf(stderr, "Failed to create RBTree\n");
+        exit(EXIT_FAILURE);
+    }
+
+    double t0 = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        rb_tree_insert(t, keys[i]);
+    }
+    report("bottom-up", "insert", n, now_sec() - t0);
+
+    size_t found = 0;
+    t0 = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        found += rb_tree_search(t, keys[i]) != t->nil;
+    }
+    report("bottom-up", "search", n, now_sec() - t0);
+
+    t0 = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        rb_tree_delete(t, keys[i]);
+    }
+    report("bottom-up", "delete", n, now_sec() - t0);
+
+    if (found != n || t->root != t->nil) {
+        fprintf(stderr, "bottom-up: inconsistent result\n");
+        exit(EXIT_FAILURE);
+    }
+    rb_tree_destroy(t);
+}
+
+/**
+ * @brief Top-down (no parent pointer) tree: insert, search, delete.
+ */
+static void bench_top_down(const int *keys, size_t n) {
+    RBTDTree *t = rb_td_tree_create();
+    if (!t) {
+        fprintf(stderr, "Failed to create RBTDTree\n");
+        exit(EXIT_FAILURE);
+    }
+
+    double t0 = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        rb_td_tree_insert(t, keys[i]);
+    }
+    report("top-down", "insert", n, now_sec() - t0);
+
+    size_t found = 0;
+    t0 = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        found += rb_td_tree_search(t, keys[i]) != t->nil;
+    }
+    report("top-down", "search", n, now_sec() - t0);
+
+    t0 = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        rb_td_tree_delete(t, keys[i]);
+    }
+    report("top-down", "delete", n, now_sec() - t0);
+
+    if (found != n || t->root != t->nil) {
+        fprintf(stderr, "top-down: inconsistent result\n");
+        exit(EXIT_FAILURE);
+    }
+    rb_td_tree_destroy(t);
+}
+
+/**
+ * @brief Scalar rb_tree_search() loop vs rb_tree_search_inline()
+ *        vs rb_tree_search_batch().
+ *
+ * The tree is built from keys[], then queried in a second, independent
+ * random order so lookups don't follow allocation order.
+ */
+static void bench_search_batch(const int *keys, size_t n) {
+    RBTree *t = rb_tree_create();
+    int *queries = malloc(n * sizeof(*queries));
+    RBNode **out = malloc(n * sizeof(*out));
+    if (!t || !queries || !out) {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < n; i++) {
+        rb_tree_insert(t, keys[i]);
+    }
+    make_keys(queries, n, 1);
+
+    size_t found = 0;
+    double t0 = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        found += rb_tree_search(t, queries[i]) != t->nil;
+    }
+    double scalar = now_sec() - t0;
+    report("scalar", "search", n, scalar);
+
+    size_t hits = 0;
+    t0 = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        hits += rb_tree_search_inline(t, queries[i]) != t->nil;
+    }
+    report("inline", "search", n, now_sec() - t0);
+    if (hits != found) {
+        fprintf(stderr, "inline: inconsistent result\n");
+        exit(EXIT_FAILURE);
+    }
+
+    t0 = now_sec();
+    rb_tree_search_batch(t, queries, n, out);
+    double batch = now_sec() - t0;
+    report("batch", "search", n, batch);
+
+    for (size_t i = 0; i < n; i++) {
+        found -= out[i] != t->nil && out[i]->key == queries[i];
+    }
+    if (found != 0) {
+        fprintf(stderr, "batch: inconsistent result\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("  speedup %.2fx\n", scalar / batch);
+
+    free(out);
+    free(queries);
+    rb_tree_destroy(t);
+}
+
+/**
+ * @brief Search time on a churned tree, before and after compaction.
+ *
+ * Half of the keys are deleted and re-inserted so the nodes end up
+ * scattered across the heap, then the same random queries run before
+ * and after rb_tree_compact().
+ */
+static void bench_compact(const int *keys, size_t n) {
+    RBTree *t = rb_tree_create();
+    int *queries = malloc(n * sizeof(*queries));
+    if (!t || !queries) {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < n; i++) {
+        rb_tree_insert(t, keys[i]);
+    }
+    for (size_t i = 0; i < n; i += 2) {
+        rb_tree_delete(t, keys[i]);
+    }
+    for (size_t i = 0; i < n; i += 2) {
+        rb_tree_insert(t, keys[i]);
+    }
+    make_keys(queries, n, 1);
+
+    size_t found = 0;
+    double t0 = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        found += rb_tree_search(t, queries[i]) != t->nil;
+    }
+    report("scattered", "search", n, now_sec() - t0);
+
+    t0 = now_sec();
+    if (rb_tree_compact(t) != 0) {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    report("compact", "move", n, now_sec() - t0);
+
+    t0 = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        found -= rb_tree_search(t, queries[i]) != t->nil;
+    }
+    report("compacted", "search", n, now_sec() - t0);
+
+    if (found != 0) {
+        fprintf(stderr, "compact: inconsistent result\n");
+        exit(EXIT_FAILURE);
+    }
+    free(queries);
+    rb_tree_destroy(t);
+}
+
+/**
+ * @brief Map key k of 0..n-1 onto [0, INT_MAX), keeping keys distinct.
+ */
+static int spread_key(int k, size_t n) {
+    return (int)((int64_t)k * INT_MAX / (int64_t)n);
+}
+
+/**
+ * @brief Memory and point lookups: RBTree vs its packed export.
+ *
+ * Keys are spread evenly over the int range, so blocks need about
+ * log2(128 * INT_MAX / n) bits per key (19 at n = 1M) rather than the
+ * 8 a dense 0..n-1 set would.
+ */
+static void bench_packed(const int *keys, size_t n) {
+    RBTree *t = rb_tree_create();
+    int *queries = malloc(n * sizeof(*queries));
+    if (!t || !queries) {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < n; i++) {
+        rb_tree_insert(t, spread_key(keys[i], n));
+    }
+    make_keys(queries, n, 1);
+    for (size_t i = 0; i < n; i++) {
+        queries[i] = spread_key(queries[i], n);
+    }
+
+    double t0 = now_sec();
+    RBPacked *p = rb_packed_export(t);
+    if (!p) {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    report("packed", "export", n, now_sec() - t0);
+    printf("  memory: tree %zu B/key (nodes only), packed %.2f B/key\n",
+           sizeof(RBNode), (double)rb_packed_bytes(p) / (double)n);
+
+    size_t found = 0;
+    t0 = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        found += rb_tree_search(t, queries[i]) != t->nil;
+    }
+    report("tree", "search", n, now_sec() - t0);
+
+    t0 = now_sec();
+    for (size_t i = 0; i < n; i++) {
+        found -= rb_packed_contains(p, queries[i]);
+    }
+    report("packed", "search", n, now_sec() - t0);
+
+    if (found != 0) {
+        fprintf(stderr, "packed: inconsistent result\n");
+        exit(EXIT_FAILURE);
+    }
+    rb_packed_destroy(p);
+    free(queries);
+    rb_tree_destroy(t);
+}
+
+int main(int argc, char **argv) {
+    size_t n = DEFAULT_N;
+    if (argc > 1) {
+        n = strtoul(argv[1], NULL, 10);
+    }
+    if (n == 0) {
+        fprintf(stderr, "Usage: %s [n]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int *keys = malloc(n * sizeof(*keys));
+    if (!keys) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("n = %zu, node size: bottom-up %zu B, top-down %zu B\n", n,
+           sizeof(RBNode), sizeof(RBTDNode));
+
+    puts("sequential keys:");
+    make_keys(keys, n, 0);
+    bench_bottom_up(keys, n);
+    bench_top_down(keys, n);
+
+    puts("random keys:");
+    make_keys(keys, n, 1);
+    bench_bottom_up(keys, n);
+    bench_top_down(keys, n);
+
+    printf("batched search (random keys, batch of %d):\n", RB_SEARCH_BATCH);
+    bench_search_batch(keys, n);
+
+    puts("compaction (random keys, half deleted and re-inserted):");
+    bench_compact(keys, n);
+
+    puts("packed export (random keys):");
+    bench_packed(keys, n);
+
+    free(keys);
+    return EXIT_SUCCESS;
+}
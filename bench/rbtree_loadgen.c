@@ -0,0 +1,230 @@
+// bench/rbtree_loadgen.c
+#define _GNU_SOURCE
+
+#include "../include/rb_protocol.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @struct LoadConfig
+ * @brief Command line settings.
+ */
+typedef struct {
+    const char *path; // Server socket.
+    int clients;      // Concurrent client processes.
+    long requests;    // Requests per client.
+    int depth;        // Requests in flight per client (pipelining).
+    int keyspace;     // Keys are drawn from [0, keyspace).
+} LoadConfig;
+
+/**
+ * @struct LoadResult
+ * @brief What each client reports back to the parent.
+ */
+typedef struct {
+    long done;     // Responses received.
+    long found;    // Searches / deletes that hit.
+    long errors;   // Bad or truncated responses.
+} LoadResult;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int write_all(int fd, const void *buf, size_t len) {
+    const unsigned char *p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int read_all(int fd, void *buf, size_t len) {
+    unsigned char *p = buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Pick a request: 60% search, 20% insert, 15% delete, 5% range.
+ */
+static RBRequest make_request(unsigned int *seed, int keyspace) {
+    RBRequest r = {0};
+    int dice = rand_r(seed) % 100;
+    r.key = rand_r(seed) % keyspace;
+    if (dice < 60) {
+        r.op = RB_REQ_SEARCH;
+    } else if (dice < 80) {
+        r.op = RB_REQ_INSERT;
+    } else if (dice < 95) {
+        r.op = RB_REQ_DELETE;
+    } else {
+        r.op = RB_REQ_RANGE;
+        r.key2 = r.key + 100;
+    }
+    return r;
+}
+
+/**
+ * @brief One client: send `depth` requests, read their responses, repeat.
+ */
+static LoadResult run_client(const LoadConfig *cfg, int id) {
+    LoadResult res = {0};
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    strncpy(addr.sun_path, cfg->path, sizeof(addr.sun_path) - 1);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("connect");
+        res.errors = 1;
+        return res;
+    }
+
+    RBRequest *reqs = calloc((size_t)cfg->depth, sizeof(*reqs));
+    int32_t *keys = malloc(RB_RANGE_MAX * sizeof(*keys));
+    if (!reqs || !keys) {
+        res.errors = 1;
+        close(fd);
+        return res;
+    }
+
+    unsigned int seed = 12345u + (unsigned int)id * 7919u;
+    while (res.done < cfg->requests) {
+        long left = cfg->requests - res.done;
+        int burst = left < cfg->depth ? (int)left : cfg->depth;
+        for (int i = 0; i < burst; i++) {
+            reqs[i] = make_request(&seed, cfg->keyspace);
+        }
+        if (write_all(fd, reqs, (size_t)burst * sizeof(*reqs)) < 0) {
+            res.errors++;
+            break;
+        }
+
+        for (int i = 0; i < burst; i++) {
+            RBResponse r;
+            if (read_all(fd, &r, sizeof(r)) < 0 ||
+                (r.count && read_all(fd, keys, r.count * sizeof(*keys)) < 0)) {
+                res.errors++;
+                goto out;
+            }
+            if (r.op != reqs[i].op || r.status >= RB_STATUS_TRUNCATED) {
+                res.errors++;
+            }
+            res.found += r.status == RB_STATUS_OK &&
+                         (r.op == RB_REQ_SEARCH || r.op == RB_REQ_DELETE);
+            res.done++;
+        }
+    }
+out:
+    free(keys);
+    free(reqs);
+    close(fd);
+    return res;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s <socket> [-c clients] [-n requests] [-d depth] "
+            "[-k keyspace]\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    LoadConfig cfg = {NULL, 4, 100000, 64, 100000};
+    int opt;
+    while ((opt = getopt(argc, argv, "c:n:d:k:")) != -1) {
+        switch (opt) {
+        case 'c':
+            cfg.clients = atoi(optarg);
+            break;
+        case 'n':
+            cfg.requests = atol(optarg);
+            break;
+        case 'd':
+            cfg.depth = atoi(optarg);
+            break;
+        case 'k':
+            cfg.keyspace = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc - 1 || cfg.clients < 1 || cfg.requests < 1 ||
+        cfg.depth < 1 || cfg.keyspace < 1) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    cfg.path = argv[optind];
+
+    // One process per client, each reporting back through a pipe
+    int fds[2];
+    if (pipe(fds) < 0) {
+        perror("pipe");
+        return EXIT_FAILURE;
+    }
+    double t0 = now_sec();
+    for (int i = 0; i < cfg.clients; i++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return EXIT_FAILURE;
+        }
+        if (pid == 0) {
+            close(fds[0]);
+            LoadResult r = run_client(&cfg, i);
+            int rc = write_all(fds[1], &r, sizeof(r));
+            _exit(rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+    close(fds[1]);
+
+    LoadResult total = {0};
+    for (int i = 0; i < cfg.clients; i++) {
+        LoadResult r;
+        if (read_all(fds[0], &r, sizeof(r)) < 0) {
+            total.errors++;
+            continue;
+        }
+        total.done += r.done;
+        total.found += r.found;
+        total.errors += r.errors;
+    }
+    while (wait(NULL) > 0) {
+    }
+    double sec = now_sec() - t0;
+
+    printf("clients %d, depth %d, keyspace %d\n", cfg.clients, cfg.depth,
+           cfg.keyspace);
+    printf("  %ld requests in %.3f s: %.0f req/s\n", total.done, sec,
+           (double)total.done / sec);
+    printf("  hits %ld, errors %ld\n", total.found, total.errors);
+    return total.errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+// include/interval_tree.h
+#ifndef INTERVAL_TREE_H
+#define INTERVAL_TREE_H
+
+#include "rb_tree.h"
+
+// == Interval Tree Data Structures ==
+
+/**
+ * @struct IntervalNode
+ * @brief A closed interval [lo, hi] stored in a Red-Black Tree.
+ *
+ * The embedded RBNode comes first, so an IntervalNode can be used
+ * wherever an RBNode is expected.  node.key holds lo; max holds the
+ * largest hi anywhere in this node's subtree, and is kept correct by
+ * the RBTree augment callback.
+ */
+typedef struct {
+    RBNode node; // Tree links; node.key is the low endpoint.
+    int hi;      // High endpoint (inclusive).
+    int max;     // Maximum hi in this subtree.
+} IntervalNode;
+
+/**
+ * @brief Callback invoked for every interval found by a query.
+ *
+ * @param n    The matching interval.
+ * @param ctx  The user pointer passed to the query.
+ */
+typedef void (*IntervalVisitFn)(const IntervalNode *n, void *ctx);
+
+// == Interval Tree methods ==
+
+/**
+ * @brief Allocate an empty interval tree.
+ *
+ * This is a regular RBTree with the max-endpoint augment installed;
+ * destroy it with rb_tree_destroy().  Only use the interval_tree_*
+ * functions to modify it.
+ *
+ * @return Pointer to the new RBTree on success, NULL on failure.
+ */
+RBTree *interval_tree_create(void);
+
+/**
+ * @brief Insert the closed interval [lo, hi].
+ *
+ * Duplicates are allowed.  Does nothing if lo > hi.
+ *
+ * @param t   The interval tree.
+ * @param lo  Low endpoint.
+ * @param hi  High endpoint.
+ */
+void interval_tree_insert(RBTree *t, int lo, int hi);
+
+/**
+ * @brief Delete one copy of the interval [lo, hi].
+ *
+ * Does nothing if the interval is not present.
+ *
+ * @param t   The interval tree.
+ * @param lo  Low endpoint.
+ * @param hi  High endpoint.
+ */
+void interval_tree_delete(RBTree *t, int lo, int hi);
+
+/**
+ * @brief Report every interval overlapping [lo, hi], in order of lo.
+ *
+ * Subtrees whose max endpoint is below lo, and right subtrees whose
+ * low endpoints start after hi, are skipped.  Every ancestor of a
+ * reported interval is still visited, so the query costs
+ * O(min(n, k log n)) for k results, not O(log n + k): a few intervals
+ * with a large hi scattered among short ones each pull in their own
+ * path from the root.
+ *
+ * @param t      The interval tree.
+ * @param lo     Low endpoint of the query.
+ * @param hi     High endpoint of the query.
+ * @param visit  Called for each overlapping interval (may be NULL).
+ * @param ctx    Passed through to visit.
+ *
+ * @return The number of overlapping intervals.
+ */
+size_t interval_tree_overlap(RBTree *t, int lo, int hi, IntervalVisitFn visit,
+                             void *ctx);
+
+/**
+ * @brief Report every interval containing the point p.
+ *
+ * Shorthand for interval_tree_overlap(t, p, p, visit, ctx).
+ *
+ * @return The number of intervals containing p.
+ */
+size_t interval_tree_stab(RBTree *t, int p, IntervalVisitFn visit,
+                          void *ctx);
+
+#endif // INTERVAL_TREE_H
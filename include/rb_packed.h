@@ -0,0 +1,97 @@
+// include/rb_packed.h
+#ifndef RB_PACKED_H
+#define RB_PACKED_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rb_tree.h"
+
+// == Compressed read-only key set ==
+//
+// Keys are stored sorted, in blocks of RB_PACKED_BLOCK.  Each block is
+// frame-of-reference encoded: its first key is the base, and every key
+// is stored as (key - base) using just enough bits for the largest
+// difference in that block.  The bits are interleaved over
+// RB_PACKED_LANES 32-bit lanes so that decoding runs the same shifts on
+// four lanes at once (one SIMD register) with no data-dependent branch.
+// A sparse index holding the first key of each block finds the block.
+
+#define RB_PACKED_BLOCK 128
+#define RB_PACKED_LANES 4
+
+/**
+ * @struct RBPacked
+ * @brief Immutable, compressed sorted copy of a tree's keys.
+ */
+typedef struct {
+    size_t count;     // Number of keys (duplicates included).
+    size_t nblocks;   // Number of blocks.
+    int *first;       // Sparse index: first (smallest) key of each block.
+    uint32_t *offset; // Start of each block in data, in 32-bit words.
+    uint8_t *width;   // Bits per key of each block (0..32).
+    uint32_t *data;   // Packed key differences of all blocks.
+} RBPacked;
+
+/**
+ * @brief Callback invoked for every key found by a range query.
+ *
+ * @param key  The key.
+ * @param ctx  The user pointer passed to the query.
+ *
+ * @return 0 to continue, nonzero to stop the query early.
+ */
+typedef int (*RBPackedVisitFn)(int key, void *ctx);
+
+/**
+ * @brief Build a compressed copy of all keys in t.
+ *
+ * The tree is not modified and may be destroyed afterwards.
+ *
+ * @param t  The Red-Black Tree to export.
+ *
+ * @return The packed set, or NULL on allocation failure.
+ */
+RBPacked *rb_packed_export(RBTree *t);
+
+/**
+ * @brief Free a packed set.
+ *
+ * @param p  The packed set (may be NULL).
+ */
+void rb_packed_destroy(RBPacked *p);
+
+/**
+ * @brief Check whether key is present.
+ *
+ * Binary-searches the sparse index, then decodes one block.
+ *
+ * @param p    The packed set.
+ * @param key  The key to look for.
+ *
+ * @return 1 if present, 0 otherwise.
+ */
+int rb_packed_contains(const RBPacked *p, int key);
+
+/**
+ * @brief Visit every key with lo <= key <= hi, in ascending order.
+ *
+ * @param p      The packed set.
+ * @param lo     Smallest key to report.
+ * @param hi     Largest key to report.
+ * @param visit  Called for each key in range (may be NULL).
+ * @param ctx    Passed through to visit.
+ *
+ * @return The number of keys visited.
+ */
+size_t rb_packed_range(const RBPacked *p, int lo, int hi,
+                       RBPackedVisitFn visit, void *ctx);
+
+/**
+ * @brief Total heap bytes used by the packed set.
+ *
+ * @param p  The packed set.
+ */
+size_t rb_packed_bytes(const RBPacked *p);
+
+#endif // RB_PACKED_H
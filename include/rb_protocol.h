@@ -0,0 +1,62 @@
+// include/rb_protocol.h
+#ifndef RB_PROTOCOL_H
+#define RB_PROTOCOL_H
+
+#include <stdint.h>
+
+// == rbtree server wire protocol ==
+//
+// Clients send fixed-size RBRequest frames over a Unix domain stream
+// socket and may pipeline as many as they like before reading.  The
+// server answers every request, in order, with an RBResponse header;
+// a range response is followed by `count` int32_t keys.  Both ends run
+// on the same host, so fields are in host byte order.
+
+/**
+ * @enum RBRequestOp
+ * @brief Operations a client can request.
+ */
+typedef enum {
+    RB_REQ_INSERT = 1, // Insert key.
+    RB_REQ_DELETE = 2, // Delete one copy of key.
+    RB_REQ_SEARCH = 3, // Is key present?
+    RB_REQ_RANGE = 4,  // All keys in [key, key2], ascending.
+} RBRequestOp;
+
+/**
+ * @enum RBStatus
+ * @brief Result codes carried in RBResponse.status.
+ */
+typedef enum {
+    RB_STATUS_OK = 0,          // Done / found.
+    RB_STATUS_NOT_FOUND = 1,   // Search or delete missed.
+    RB_STATUS_TRUNCATED = 2,   // Range had more than RB_RANGE_MAX keys.
+    RB_STATUS_BAD_REQUEST = 3, // Unknown op.
+} RBStatus;
+
+// Most keys a single range response carries.
+#define RB_RANGE_MAX 4096
+
+/**
+ * @struct RBRequest
+ * @brief One request frame (12 bytes).
+ */
+typedef struct {
+    uint8_t op;     // RBRequestOp.
+    uint8_t pad[3]; // Zero.
+    int32_t key;    // Key, or range low end.
+    int32_t key2;   // Range high end (ignored otherwise).
+} RBRequest;
+
+/**
+ * @struct RBResponse
+ * @brief One response header (8 bytes).
+ */
+typedef struct {
+    uint8_t op;     // Echo of the request op.
+    uint8_t status; // RBStatus.
+    uint16_t pad;   // Zero.
+    uint32_t count; // Number of int32_t keys that follow (range only).
+} RBResponse;
+
+#endif // RB_PROTOCOL_H
@@ -0,0 +1,146 @@
+// include/rb_stats.h
+#ifndef RB_STATS_H
+#define RB_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "rb_tree.h"
+
+// == Latency Histograms ==
+
+// Each power of two is split into 2^RB_HIST_SUB_BITS linear sub-buckets,
+// so every recorded value is within 12.5% of its bucket's bounds.
+#define RB_HIST_SUB_BITS 3
+#define RB_HIST_SUB_COUNT (1 << RB_HIST_SUB_BITS)
+#define RB_HIST_BUCKETS (64 * RB_HIST_SUB_COUNT)
+
+/**
+ * @struct RBHistogram
+ * @brief HDR-style log-bucketed histogram of 64-bit values.
+ *
+ * Fixed size, no allocation on record, constant-time record.
+ */
+typedef struct {
+    uint64_t counts[RB_HIST_BUCKETS]; // Samples per bucket.
+    uint64_t total;                   // Number of samples.
+    uint64_t sum;                     // Sum of samples (for the mean).
+    uint64_t max;                     // Largest sample seen.
+} RBHistogram;
+
+/**
+ * @enum RBOp
+ * @brief Operations whose latency is recorded.
+ */
+typedef enum { RB_OP_INSERT, RB_OP_DELETE, RB_OP_SEARCH, RB_OP_COUNT } RBOp;
+
+/**
+ * @struct RBStats
+ * @brief Per-tree latency histograms (in ns) and event counters.
+ */
+typedef struct RBStats {
+    RBHistogram latency[RB_OP_COUNT];      // Latency per operation.
+    uint64_t events[RB_TRACE_EVENT_COUNT]; // Rotations / fixup cases.
+} RBStats;
+
+/**
+ * @brief Record one sample.
+ *
+ * @param h  The histogram.
+ * @param v  The value (e.g. nanoseconds).
+ */
+void rb_histogram_record(RBHistogram *h, uint64_t v);
+
+/**
+ * @brief Record the same sample n times.
+ *
+ * @param h  The histogram.
+ * @param v  The value (e.g. nanoseconds).
+ * @param n  Number of samples.
+ */
+void rb_histogram_record_n(RBHistogram *h, uint64_t v, uint64_t n);
+
+/**
+ * @brief Return the value at percentile p (0..100).
+ *
+ * The result is the upper bound of the bucket holding that sample,
+ * capped at the exact maximum.  Returns 0 for an empty histogram.
+ *
+ * @param h  The histogram.
+ * @param p  Percentile, e.g. 99.9.
+ */
+uint64_t rb_histogram_percentile(const RBHistogram *h, double p);
+
+/**
+ * @brief Monotonic clock in nanoseconds (clock_gettime).
+ */
+uint64_t rb_stats_now(void);
+
+// == Tree statistics and tracing ==
+
+/**
+ * @brief Start recording latency histograms for t.
+ *
+ * @param t  The Red-Black Tree.
+ *
+ * @return 0 on success, -1 if allocation failed or the library was
+ *         built without RB_TREE_STATS.
+ */
+int rb_tree_stats_enable(RBTree *t);
+
+/**
+ * @brief Print per-operation latency percentiles and event counts.
+ *
+ * @param t    The Red-Black Tree.
+ * @param out  Where to print (e.g. stdout).
+ */
+void rb_tree_stats_dump(RBTree *t, FILE *out);
+
+/**
+ * @brief Register (or clear, with NULL) the trace callback of t.
+ *
+ * @param t    The Red-Black Tree.
+ * @param fn   Called on every rotation and fixup case.
+ * @param ctx  Passed through to fn.
+ */
+void rb_tree_set_trace(RBTree *t, RBTraceFn fn, void *ctx);
+
+// == Hot-path hooks ==
+//
+// Built with -DRB_TREE_STATS these time operations and fire trace
+// events; otherwise they expand to nothing and cost nothing.
+
+#ifdef RB_TREE_STATS
+#define RB_STATS_START(t, t0) uint64_t t0 = (t)->stats ? rb_stats_now() : 0
+#define RB_STATS_STOP(t, op, t0)                                               \
+    do {                                                                       \
+        if ((t)->stats) {                                                      \
+            rb_histogram_record(&(t)->stats->latency[op],                      \
+                                rb_stats_now() - (t0));                        \
+        }                                                                      \
+    } while (0)
+// Records n samples of the mean latency since t0 (for batched calls)
+#define RB_STATS_STOP_N(t, op, t0, n)                                          \
+    do {                                                                       \
+        if ((t)->stats && (n) > 0) {                                           \
+            rb_histogram_record_n(&(t)->stats->latency[op],                    \
+                                  (rb_stats_now() - (t0)) / (n), (n));         \
+        }                                                                      \
+    } while (0)
+#define RB_TRACE(t, ev, n)                                                     \
+    do {                                                                       \
+        if ((t)->stats) {                                                      \
+            (t)->stats->events[ev]++;                                          \
+        }                                                                      \
+        if ((t)->trace) {                                                      \
+            (t)->trace((t), (ev), (n), (t)->trace_ctx);                        \
+        }                                                                      \
+    } while (0)
+#else
+#define RB_STATS_START(t, t0) ((void)0)
+#define RB_STATS_STOP(t, op, t0) ((void)0)
+#define RB_STATS_STOP_N(t, op, t0, n) ((void)0)
+#define RB_TRACE(t, ev, n) ((void)0)
+#endif
+
+#endif // RB_STATS_H
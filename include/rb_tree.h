@@ -29,17 +29,104 @@ typedef struct RBNode {
     struct RBNode *parent; // Parent (or nil for root).
 } RBNode;
 
+struct RBTree;
+
+/**
+ * @enum RBTraceEvent
+ * @brief Structural events reported to a trace callback.
+ *
+ * Fixup cases are numbered as in rb_tree_insert_fixup() and
+ * rb_tree_delete_fixup(); mirror cases report the same event.
+ */
+typedef enum {
+    RB_TRACE_LEFT_ROTATE,
+    RB_TRACE_RIGHT_ROTATE,
+    RB_TRACE_INSERT_CASE1, // Uncle red: recolor and move up.
+    RB_TRACE_INSERT_CASE2, // Uncle black, zig-zag: rotate parent.
+    RB_TRACE_INSERT_CASE3, // Uncle black, straight: rotate grandparent.
+    RB_TRACE_DELETE_CASE1, // Sibling red: rotate parent.
+    RB_TRACE_DELETE_CASE2, // Sibling black with black children: recolor.
+    RB_TRACE_DELETE_CASE3, // Sibling's far child black: rotate sibling.
+    RB_TRACE_DELETE_CASE4, // Sibling's far child red: rotate parent, done.
+    RB_TRACE_EVENT_COUNT
+} RBTraceEvent;
+
+/**
+ * @brief Trace callback, fired on rotations and fixup cases.
+ *
+ * Only called when the library is built with RB_TREE_STATS.
+ *
+ * @param t    The tree being modified.
+ * @param ev   What happened.
+ * @param n    The pivot (rotations) or current node (fixup cases).
+ * @param ctx  The pointer given to rb_tree_set_trace().
+ */
+typedef void (*RBTraceFn)(struct RBTree *t, RBTraceEvent ev, RBNode *n,
+                          void *ctx);
+
+struct RBStats;
+
+/**
+ * @struct RBRegion
+ * @brief One contiguous block of node slots created by compaction.
+ *
+ * Nodes living in a region are not individually malloc'd; the region
+ * is freed once its last live node is released.
+ */
+typedef struct RBRegion {
+    struct RBRegion *next; // Next region owned by the same tree.
+    unsigned char *base;   // cap * node_size bytes of node slots.
+    size_t cap;            // Number of slots.
+    size_t live;           // Slots still holding a node of the tree.
+} RBRegion;
+
+/**
+ * @brief Callback invoked for every node visited by a range query.
+ *
+ * @param n    The node.
+ * @param ctx  The user pointer passed to the query.
+ *
+ * @return 0 to continue, nonzero to stop the query early.
+ */
+typedef int (*RBVisitFn)(RBNode *n, void *ctx);
+
+/**
+ * @brief Augmentation callback.
+ *
+ * Recomputes the per-node summary of n (e.g. a subtree maximum) from
+ * n itself and its two children, which are already up to date.
+ * Never called with the nil sentinel.
+ */
+typedef void (*RBAugmentFn)(struct RBTree *t, RBNode *n);
+
 /**
  * @struct RBTree
  * @brief The Red-Black Tree container.
  *
  * Holds a pointer to the root node and to the shared sentinel (nil).
+ * An optional augment callback lets a variant built on RBTree keep
+ * per-subtree data correct through rotations and both fixups.
  */
-typedef struct {
-    RBNode *root; // Root of the tree (or nil if empty).
-    RBNode *nil;  // Sentinel node, used in place of NULL.
+typedef struct RBTree {
+    RBNode *root;          // Root of the tree (or nil if empty).
+    RBNode *nil;           // Sentinel node, used in place of NULL.
+    RBAugmentFn augment;   // Subtree summary update (or NULL if none).
+    size_t size;           // Number of nodes in the tree.
+    size_t node_size;      // Bytes per node (RBNode or an embedding struct).
+    RBRegion *regions;     // Regions created by compaction (or NULL).
+    RBRegion *compacting;  // Region of the running compaction pass.
+    size_t compact_scan;   // Next slot whose children get moved.
+    size_t compact_fill;   // Slots filled so far in this pass.
+    RBRegion *sweeping;    // Older region being emptied (or NULL).
+    size_t sweep_slot;     // Next slot of sweeping to check.
+    struct RBStats *stats; // Latency histograms (or NULL if disabled).
+    RBTraceFn trace;       // Trace callback (or NULL).
+    void *trace_ctx;       // Passed through to trace.
 } RBTree;
 
+// Number of lookups rb_tree_search_batch() keeps in flight together.
+#define RB_SEARCH_BATCH 16
+
 // == Red-Black Tree methods ==
 
 /**
@@ -57,11 +144,10 @@ RBTree *rb_tree_create(void);
 /**
  * @brief Destroy a Red-Black Tree and free its memory.
  *
- * @param t  Pointer to the RBTree to destroy.
+ * Frees every node, any compaction regions, the sentinel and the
+ * tree struct.
  *
- * @note This currently only frees the sentinel and tree struct.
- *       You must traverse and free all data nodes before calling
- *       this (TODO in future).
+ * @param t  Pointer to the RBTree to destroy.
  */
 void rb_tree_destroy(RBTree *t);
 
@@ -113,6 +199,18 @@ void rb_tree_right_rotate(RBTree *t, RBNode *y);
  */
 void rb_tree_insert(RBTree *t, int key);
 
+/**
+ * @brief Link a caller-allocated node into the Red-Black Tree.
+ *
+ * Same as rb_tree_insert(), but the node (and anything the caller
+ * embeds around it) is allocated by the caller.  Only z->key needs to
+ * be set; links and color are initialized here.
+ *
+ * @param t  Pointer to the RBTree.
+ * @param z  The node to link in.
+ */
+void rb_tree_insert_node(RBTree *t, RBNode *z);
+
 /**
  * @brief Delete a key from the Red-Black Tree.
  *
@@ -122,8 +220,75 @@ void rb_tree_insert(RBTree *t, int key);
  *
  * @param t   Pointer to the RBTree.
  * @param key The integer key to delete.
+ *
+ * @return 1 if a node was deleted, 0 if the key was not found.
+ */
+int rb_tree_delete(RBTree *t, int key);
+
+/**
+ * @brief Unlink a node from the Red-Black Tree without freeing it.
+ *
+ * Afterwards z->parent is NULL; the node may be inserted again.
+ *
+ * @param t  Pointer to the RBTree.
+ * @param z  The node to unlink (must be in t, not nil).
+ */
+void rb_tree_delete_node(RBTree *t, RBNode *z);
+
+/**
+ * @brief Release the memory of a node unlinked by rb_tree_delete_node().
+ *
+ * Nodes moved by compaction live inside a region and must not be passed
+ * to free() directly; this handles both cases.
+ *
+ * @param t  Pointer to the RBTree the node belonged to.
+ * @param n  The unlinked node.
+ */
+void rb_tree_free_node(RBTree *t, RBNode *n);
+
+/**
+ * @brief Run part of a compaction pass.
+ *
+ * A pass moves every node into one freshly allocated contiguous
+ * region, in breadth-first order, so the top levels that every search
+ * touches share a few cache lines.  Each call moves at most about
+ * budget nodes, so a pass can be spread over idle periods.  Inserts
+ * and deletes between calls don't stop the pass: new nodes stay where
+ * they were allocated, and nodes that rotations move above the scan
+ * front are left behind.  Once the breadth-first part is done, the
+ * pass sweeps the older regions and moves what is left in them (into
+ * free slots of the new region, or to the heap once it is full), so
+ * every older region is released when the pass ends.  Regions are
+ * only released between passes, so memory peaks at about two regions
+ * of the tree's size.
+ *
+ * Node addresses are not stable: a moved node is copied to its new
+ * slot and the old address is released.  Every RBNode pointer held
+ * across a call (from rb_tree_search(), rb_tree_search_batch(), a
+ * range or interval_tree_overlap() visitor, ...) may dangle
+ * afterwards; look the node up again by key.
+ *
+ * @param t       Pointer to the RBTree.
+ * @param budget  Maximum number of nodes to move, or of old region
+ *                slots to check, in this call.
+ *
+ * @return 1 if the pass is complete, 0 if more calls are needed,
+ *         -1 if the region could not be allocated.
+ */
+int rb_tree_compact_step(RBTree *t, size_t budget);
+
+/**
+ * @brief Run a whole compaction pass at once.
+ *
+ * Finishes the running pass if there is one, otherwise runs a new one.
+ * Like rb_tree_compact_step(), this moves nodes: RBNode pointers held
+ * across the call may dangle, so look nodes up again by key.
+ *
+ * @param t  Pointer to the RBTree.
+ *
+ * @return 0 on success, -1 if the region could not be allocated.
  */
-void rb_tree_delete(RBTree *t, int key);
+int rb_tree_compact(RBTree *t);
 
 /**
  * @brief Traverse the tree in-order and return the node with the given key.
@@ -132,9 +297,46 @@ void rb_tree_delete(RBTree *t, int key);
  * @param n  The current node to start from (usually t->root).
  *
  * @return Pointer to the node with the key, or t->nil if not found.
+ *
+ * See rb_tree_search_inline() in rb_tree_inline.h for a version that
+ * can be inlined into the caller's loop.
  */
 RBNode *rb_tree_search(RBTree *t, int key);
 
+/**
+ * @brief Look up many keys at once, hiding memory latency.
+ *
+ * Lookups are advanced in groups of RB_SEARCH_BATCH, one tree level
+ * at a time in lockstep, prefetching each next child.  The cache misses
+ * of a group are then in flight together instead of one after another.
+ * Results are identical to calling rb_tree_search() for each key.
+ * With statistics enabled, each key is recorded as one search taking
+ * the mean per-key time of the whole call.
+ *
+ * @param t     The Red-Black Tree to search.
+ * @param keys  The keys to look up.
+ * @param n     Number of keys.
+ * @param out   out[i] receives the node for keys[i], or t->nil.
+ */
+void rb_tree_search_batch(RBTree *t, const int *keys, size_t n, RBNode **out);
+
+/**
+ * @brief Visit every node with lo <= key <= hi, in key order.
+ *
+ * Only subtrees that can hold such keys are entered, so the query costs
+ * O(log n + k) for k results.  The walk ends early if visit returns
+ * nonzero.
+ *
+ * @param t      The Red-Black Tree.
+ * @param lo     Smallest key to report.
+ * @param hi     Largest key to report.
+ * @param visit  Called for each node in range (may be NULL).
+ * @param ctx    Passed through to visit.
+ *
+ * @return The number of nodes visited.
+ */
+size_t rb_tree_range(RBTree *t, int lo, int hi, RBVisitFn visit, void *ctx);
+
 /**
  * @brief Print a node’s key and color to stdout.
  *
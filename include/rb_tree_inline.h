@@ -0,0 +1,113 @@
+// include/rb_tree_inline.h
+#ifndef RB_TREE_INLINE_H
+#define RB_TREE_INLINE_H
+
+#include "rb_tree.h"
+
+// == Header-only fast path ==
+//
+// static inline copies of the hottest tree primitives, for callers that
+// want them inlined into their own loops instead of paying a call into
+// rb_tree.c for every lookup.  rb_tree.c is built on these same
+// functions, so both paths always behave identically, except that the
+// inline versions never touch the statistics or trace hooks: searches
+// made here are not timed and rotations made here are not traced.
+
+/**
+ * @brief Return the node with the given key, or t->nil if not found.
+ *
+ * Same result as rb_tree_search(), without latency recording.
+ *
+ * @param t    The Red-Black Tree.
+ * @param key  The key to search for.
+ */
+static inline RBNode *rb_tree_search_inline(const RBTree *t, int key) {
+    RBNode *x = t->root;
+    while (x != t->nil && x->key != key) {
+        // Less goes left, greater or equal goes right.  Indexing keeps
+        // the step branch-free (a conditional move) even under PGO, so
+        // independent lookups in a loop can overlap their cache misses.
+        RBNode *next[2] = {x->left, x->right};
+        x = next[key >= x->key];
+    }
+    return x;
+}
+
+/**
+ * @brief Left-rotate the subtree rooted at x (see rb_tree_left_rotate()).
+ *
+ * Keeps augmented summaries up to date, but does not fire the trace hook.
+ *
+ * @param t  The Red-Black Tree.
+ * @param x  Pivot node where rotation is applied (must not be nil).
+ */
+static inline void rb_tree_left_rotate_inline(RBTree *t, RBNode *x) {
+    RBNode *y = x->right;    // 1) Set y
+    x->right = y->left;      // 2) Turn y's left subtree into x's right
+    if (y->left != t->nil) { // 3) Update parent pointer for that subtree
+        y->left->parent = x;
+    }
+
+    // 4) Link y to x's former parent
+    y->parent = x->parent;
+
+    if (x->parent == t->nil) {
+        // 5a) x was root
+        t->root = y;
+    } else if (x == x->parent->left) {
+        // 5b) x was left child
+        x->parent->left = y;
+    } else {
+        // 5c) x was right child
+        x->parent->right = y;
+    }
+
+    y->left = x;   // 6) Put x on y's left
+    x->parent = y; // 7) Update x's parent
+
+    // 8) x is now below y: refresh x's summary first, then y's
+    if (t->augment) {
+        t->augment(t, x);
+        t->augment(t, y);
+    }
+}
+
+/**
+ * @brief Right-rotate the subtree rooted at y (see rb_tree_right_rotate()).
+ *
+ * Keeps augmented summaries up to date, but does not fire the trace hook.
+ *
+ * @param t  The Red-Black Tree.
+ * @param y  Pivot node where rotation is applied (must not be nil).
+ */
+static inline void rb_tree_right_rotate_inline(RBTree *t, RBNode *y) {
+    RBNode *x = y->left;      // 1) Set x
+    y->left = x->right;       // 2) Turn x's right subtree into y's left
+    if (x->right != t->nil) { // 3) Update parent pointer for that subtree
+        x->right->parent = y;
+    }
+
+    // 4) Link x to y's former parent
+    x->parent = y->parent;
+    if (y->parent == t->nil) {
+        // 5a) y was root
+        t->root = x;
+    } else if (y == y->parent->right) {
+        // 5b) y was right child
+        y->parent->right = x;
+    } else {
+        // 5c) y was left child
+        y->parent->left = x;
+    }
+
+    x->right = y;  // 6) Put y on x's right
+    y->parent = x; // 7) Update y's parent
+
+    // 8) y is now below x: refresh y's summary first, then x's
+    if (t->augment) {
+        t->augment(t, y);
+        t->augment(t, x);
+    }
+}
+
+#endif // RB_TREE_INLINE_H
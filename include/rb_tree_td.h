@@ -0,0 +1,89 @@
+// include/rb_tree_td.h
+#ifndef RB_TREE_TD_H
+#define RB_TREE_TD_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "rb_tree.h"
+
+// == Top-down Red-Black Tree Data Structures ==
+
+/**
+ * @struct RBTDNode
+ * @brief A single node in the top-down Red-Black Tree.
+ *
+ * Unlike RBNode there is no parent pointer: the top-down algorithms
+ * rebalance on the way down, so they never need to climb back up.
+ * Children are kept in a two-element array so the left and right
+ * cases can share one code path (child[dir] / child[!dir]).
+ */
+typedef struct RBTDNode {
+    int key;                   // The key stored in this node.
+    Color color;               // RED or BLACK.
+    struct RBTDNode *child[2]; // [0] = left child, [1] = right child (or nil).
+} RBTDNode;
+
+/**
+ * @struct RBTDTree
+ * @brief The top-down Red-Black Tree container.
+ *
+ * Holds a pointer to the root node and to the shared sentinel (nil).
+ */
+typedef struct {
+    RBTDNode *root; // Root of the tree (or nil if empty).
+    RBTDNode *nil;  // Sentinel node, used in place of NULL.
+} RBTDTree;
+
+// == Top-down Red-Black Tree methods ==
+
+/**
+ * @brief Allocate and initialize an empty top-down Red-Black Tree.
+ *
+ * @return Pointer to the new RBTDTree on success, NULL on failure.
+ */
+RBTDTree *rb_td_tree_create(void);
+
+/**
+ * @brief Destroy a top-down Red-Black Tree and free all of its nodes.
+ *
+ * @param t  Pointer to the RBTDTree to destroy.
+ */
+void rb_td_tree_destroy(RBTDTree *t);
+
+/**
+ * @brief Insert a key in a single top-down pass.
+ *
+ * Splits 4-nodes (black node with two red children) by color flips
+ * on the way down and repairs any red-red violation with at most two
+ * rotations at the grandparent, so no fixup walk is needed afterwards.
+ * Equal keys go right, the same as rb_tree_insert().
+ *
+ * @param t    Pointer to the RBTDTree.
+ * @param key  The integer key to insert.
+ */
+void rb_td_tree_insert(RBTDTree *t, int key);
+
+/**
+ * @brief Delete a key in a single top-down pass.
+ *
+ * Pushes a red node down the search path so that the node finally
+ * unlinked is always red (or the root), then copies its key into the
+ * matched node.  Does nothing if the key is not present.
+ *
+ * @param t   Pointer to the RBTDTree.
+ * @param key The integer key to delete.
+ */
+void rb_td_tree_delete(RBTDTree *t, int key);
+
+/**
+ * @brief Return the node with the given key.
+ *
+ * @param t    The top-down Red-Black Tree.
+ * @param key  The key to search for.
+ *
+ * @return Pointer to the node with the key, or t->nil if not found.
+ */
+RBTDNode *rb_td_tree_search(RBTDTree *t, int key);
+
+#endif // RB_TREE_TD_H
@@ -0,0 +1,29 @@
+// include/server.h
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "rb_tree.h"
+
+/**
+ * @brief Serve a Red-Black Tree on a Unix domain socket.
+ *
+ * Runs a single-threaded epoll loop speaking the protocol in
+ * rb_protocol.h.  Each loop iteration (tick) reads once from every
+ * ready client, applies the requests read to the tree as one batch in
+ * arrival order (runs of searches go through rb_tree_search_batch()),
+ * then writes the responses back.  A client stops being read while
+ * its unsent responses, counted at their largest possible size, are
+ * over about 1 MB.
+ *
+ * Returns when SIGINT or SIGTERM is received.  Any existing file at
+ * path is replaced, and the socket file is removed on exit.
+ *
+ * @param t     The tree to serve.
+ * @param path  Filesystem path of the listening socket.
+ *
+ * @return 0 after a clean shutdown, -1 if the socket could not be set
+ *         up (a message is printed to stderr).
+ */
+int rb_server_run(RBTree *t, const char *path);
+
+#endif // SERVER_H
@@ -0,0 +1,164 @@
+// src/interval_tree.c
+#include "../include/interval_tree.h"
+
+/**
+ * @brief Recompute n->max from n->hi and its children's max.
+ *        Installed as the RBTree augment callback.
+ *
+ * @param t  The interval tree (for its nil sentinel).
+ * @param n  The node to update (never nil).
+ */
+static void interval_tree_augment(RBTree *t, RBNode *n) {
+    IntervalNode *in = (IntervalNode *)n;
+    int max = in->hi;
+
+    if (n->left != t->nil && ((IntervalNode *)n->left)->max > max) {
+        max = ((IntervalNode *)n->left)->max;
+    }
+    if (n->right != t->nil && ((IntervalNode *)n->right)->max > max) {
+        max = ((IntervalNode *)n->right)->max;
+    }
+    in->max = max;
+}
+
+/**
+ * @brief Allocate an empty interval tree.
+ */
+RBTree *interval_tree_create(void) {
+    RBTree *t = rb_tree_create();
+    if (!t) {
+        return NULL;
+    }
+    t->augment = interval_tree_augment;
+    t->node_size = sizeof(IntervalNode);
+    return t;
+}
+
+/**
+ * @brief Insert the closed interval [lo, hi].
+ *
+ * @param t   The interval tree.
+ * @param lo  Low endpoint.
+ * @param hi  High endpoint.
+ */
+void interval_tree_insert(RBTree *t, int lo, int hi) {
+    if (lo > hi) {
+        return; // Empty interval
+    }
+
+    IntervalNode *z = calloc(1, sizeof(IntervalNode));
+    if (!z) {
+        return; // Handle allocation failure
+    }
+    z->node.key = lo;
+    z->hi = hi;
+    z->max = hi;
+
+    // Linking and fixup rotations keep max correct via the augment hook
+    rb_tree_insert_node(t, &z->node);
+}
+
+/**
+ * @brief Find a node holding exactly [lo, hi] in the subtree rooted at n.
+ *
+ * Equal low endpoints can sit on both sides of each other after
+ * rotations, so on a key match both subtrees are searched; max lets us
+ * drop subtrees that cannot contain hi.
+ *
+ * @return The matching node, or NULL if not found.
+ */
+static IntervalNode *interval_tree_find(RBTree *t, RBNode *n, int lo, int hi) {
+    while (n != t->nil) {
+        IntervalNode *in = (IntervalNode *)n;
+        if (in->max < hi) {
+            return NULL;
+        }
+        if (lo < n->key) {
+            n = n->left;
+        } else if (lo > n->key) {
+            n = n->right;
+        } else {
+            if (in->hi == hi) {
+                return in;
+            }
+            IntervalNode *found = interval_tree_find(t, n->left, lo, hi);
+            if (found) {
+                return found;
+            }
+            n = n->right;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Delete one copy of the interval [lo, hi].
+ *
+ * @param t   The interval tree.
+ * @param lo  Low endpoint.
+ * @param hi  High endpoint.
+ */
+void interval_tree_delete(RBTree *t, int lo, int hi) {
+    IntervalNode *z = interval_tree_find(t, t->root, lo, hi);
+    if (!z) {
+        return; // Not found, nothing to delete
+    }
+
+    // Unlinking refreshes max along the changed path and in the fixup
+    rb_tree_delete_node(t, &z->node);
+    rb_tree_free_node(t, &z->node);
+}
+
+/**
+ * @brief Recursive worker for interval_tree_overlap().
+ *
+ *        1) Skip the whole subtree if its max endpoint is below lo.
+ *        2) Visit the left subtree.
+ *        3) Report n itself if it overlaps.
+ *        4) Visit the right subtree only if n starts at or before hi
+ *           (everything to the right starts at or after n).
+ */
+static size_t interval_tree_overlap_subtree(RBTree *t, RBNode *n, int lo,
+                                            int hi, IntervalVisitFn visit,
+                                            void *ctx) {
+    if (n == t->nil) {
+        return 0;
+    }
+    IntervalNode *in = (IntervalNode *)n;
+    if (in->max < lo) {
+        return 0;
+    }
+
+    size_t count =
+        interval_tree_overlap_subtree(t, n->left, lo, hi, visit, ctx);
+    if (n->key > hi) {
+        return count;
+    }
+    if (in->hi >= lo) {
+        if (visit) {
+            visit(in, ctx);
+        }
+        count++;
+    }
+    return count + interval_tree_overlap_subtree(t, n->right, lo, hi, visit,
+                                                 ctx);
+}
+
+/**
+ * @brief Report every interval overlapping [lo, hi].
+ */
+size_t interval_tree_overlap(RBTree *t, int lo, int hi, IntervalVisitFn visit,
+                             void *ctx) {
+    if (lo > hi) {
+        return 0;
+    }
+    return interval_tree_overlap_subtree(t, t->root, lo, hi, visit, ctx);
+}
+
+/**
+ * @brief Report every interval containing the point p.
+ */
+size_t interval_tree_stab(RBTree *t, int p, IntervalVisitFn visit,
+                          void *ctx) {
+    return interval_tree_overlap(t, p, p, visit, ctx);
+}
@@ -1,6 +1,8 @@
 // src/main.c
 #include "../include/auxiliary.h"
+#include "../include/rb_stats.h"
 #include "../include/rb_tree.h"
+#include "../include/server.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -13,16 +15,45 @@ static void print_help(void) {
     puts("  delete <key>   — delete a key");
     puts("  print          — in-order dump of the tree");
     puts("  visualize      — print the tree structure visually");
+    puts("  stats          — latency percentiles and fixup counts");
     puts("  help           — show this message");
     puts("  exit           — quit");
 }
 
-int main(void) {
+static void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s                  interactive prompt\n", prog);
+    fprintf(stderr, "       %s --serve <socket> serve over a Unix socket\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    const char *socket_path = NULL;
+    if (argc == 3 && strcmp(argv[1], "--serve") == 0) {
+        socket_path = argv[2];
+    } else if (argc != 1) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
     RBTree *t = rb_tree_create();
     if (!t) {
         fprintf(stderr, "Failed to create RBTree\n");
         return EXIT_FAILURE;
     }
+    // Only succeeds in a `make STATS=1` build; `stats` says so otherwise
+    int stats = rb_tree_stats_enable(t) == 0;
+
+    if (socket_path) {
+        // Server mode: runs until SIGINT/SIGTERM
+        printf("Serving on %s (Ctrl-C to stop)\n", socket_path);
+        fflush(stdout);
+        int rc = rb_server_run(t, socket_path);
+        if (stats) {
+            rb_tree_stats_dump(t, stdout);
+        }
+        rb_tree_destroy(t);
+        return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
     char line[LINE_SZ];
     print_help();
@@ -69,6 +100,9 @@ int main(void) {
                    "child(above))\n");
             rb_tree_visualize(t);
 
+        } else if (strcmp(cmd, "stats") == 0) {
+            rb_tree_stats_dump(t, stdout);
+
         } else if (strcmp(cmd, "help") == 0) {
             print_help();
 
@@ -0,0 +1,296 @@
+// src/rb_packed.c
+#include "../include/rb_packed.h"
+
+// Keys per lane in one block.
+#define RB_PACKED_PER_LANE (RB_PACKED_BLOCK / RB_PACKED_LANES)
+
+/**
+ * @brief Copy the keys of the subtree rooted at n, in order, to keys[].
+ *
+ * @param t     The Red-Black Tree.
+ * @param n     Current subtree root (skip if nil).
+ * @param keys  Destination array.
+ * @param i     Next free index in keys[] (updated).
+ */
+static void rb_packed_collect(RBTree *t, RBNode *n, int *keys, size_t *i) {
+    if (n == t->nil) {
+        return;
+    }
+    rb_packed_collect(t, n->left, keys, i);
+    keys[(*i)++] = n->key;
+    rb_packed_collect(t, n->right, keys, i);
+}
+
+/**
+ * @brief Number of keys in block b (only the last one can be short).
+ */
+static size_t rb_packed_block_len(const RBPacked *p, size_t b) {
+    size_t start = b * RB_PACKED_BLOCK;
+    size_t left = p->count - start;
+    return left < RB_PACKED_BLOCK ? left : RB_PACKED_BLOCK;
+}
+
+/**
+ * @brief Pack one block of differences into width-bit fields.
+ *
+ *        Difference i goes to lane i % LANES, slot i / LANES.  Each lane
+ *        is a plain little-endian bit stream of width-bit slots, and
+ *        word j of lane l is stored at out[j * LANES + l], so the four
+ *        lanes of any word sit next to each other in memory.
+ *
+ * @param v      RB_PACKED_BLOCK differences, each below 2^width.
+ * @param width  Bits per difference (1..32).
+ * @param out    width * LANES zeroed words.
+ */
+static void rb_packed_encode(const uint32_t *v, unsigned width,
+                             uint32_t *out) {
+    for (unsigned k = 0; k < RB_PACKED_PER_LANE; k++) {
+        unsigned bit = k * width;
+        unsigned w = bit / 32, sh = bit % 32;
+        for (unsigned l = 0; l < RB_PACKED_LANES; l++) {
+            uint32_t x = v[k * RB_PACKED_LANES + l];
+            out[w * RB_PACKED_LANES + l] |= x << sh;
+            if (sh + width > 32) {
+                // Slot straddles two words
+                out[(w + 1) * RB_PACKED_LANES + l] |= x >> (32 - sh);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Decode block b into RB_PACKED_BLOCK sorted keys.
+ *
+ *        The inner loop runs the same shift/mask/add on all lanes, and
+ *        whether a slot straddles two words depends only on k, so the
+ *        compiler turns it into one vector operation per slot.
+ *
+ * @param p    The packed set.
+ * @param b    Block index.
+ * @param out  Receives the keys (tail of a short block is padding).
+ */
+static void rb_packed_decode(const RBPacked *p, size_t b, int *out) {
+    const uint32_t *in = p->data + p->offset[b];
+    unsigned width = p->width[b];
+    uint32_t base = (uint32_t)p->first[b];
+
+    if (width == 0) {
+        // Every key equals the base
+        for (unsigned i = 0; i < RB_PACKED_BLOCK; i++) {
+            out[i] = (int)base;
+        }
+        return;
+    }
+
+    uint32_t mask = width == 32 ? UINT32_MAX : (UINT32_C(1) << width) - 1;
+    for (unsigned k = 0; k < RB_PACKED_PER_LANE; k++) {
+        unsigned bit = k * width;
+        unsigned w = bit / 32, sh = bit % 32;
+        const uint32_t *lo = in + w * RB_PACKED_LANES;
+        if (sh + width > 32) {
+            const uint32_t *hi = lo + RB_PACKED_LANES;
+            for (unsigned l = 0; l < RB_PACKED_LANES; l++) {
+                uint32_t x = (lo[l] >> sh) | (hi[l] << (32 - sh));
+                out[k * RB_PACKED_LANES + l] = (int)((x & mask) + base);
+            }
+        } else {
+            for (unsigned l = 0; l < RB_PACKED_LANES; l++) {
+                uint32_t x = lo[l] >> sh;
+                out[k * RB_PACKED_LANES + l] = (int)((x & mask) + base);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Index of the first block whose first key is > key
+ *        (or >= key if inclusive is set).
+ */
+static size_t rb_packed_upper_block(const RBPacked *p, int key,
+                                    int inclusive) {
+    size_t lo = 0, hi = p->nblocks;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int f = p->first[mid];
+        if (f < key || (!inclusive && f == key)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * @brief Build a compressed copy of all keys in t.
+ *
+ *        1) Collect the keys in order.
+ *        2) For each block, find the bits needed for (last - first)
+ *           and lay the blocks out back to back.
+ *        3) Encode each block's differences.
+ */
+RBPacked *rb_packed_export(RBTree *t) {
+    RBPacked *p = calloc(1, sizeof(RBPacked));
+    if (!p) {
+        return NULL;
+    }
+
+    // 1) Sorted keys
+    size_t n = t->size;
+    int *keys = malloc((n ? n : 1) * sizeof(*keys));
+    if (!keys) {
+        free(p);
+        return NULL;
+    }
+    size_t i = 0;
+    rb_packed_collect(t, t->root, keys, &i);
+    p->count = n;
+    p->nblocks = (n + RB_PACKED_BLOCK - 1) / RB_PACKED_BLOCK;
+
+    size_t nb = p->nblocks ? p->nblocks : 1;
+    p->first = malloc(nb * sizeof(*p->first));
+    p->offset = malloc(nb * sizeof(*p->offset));
+    p->width = malloc(nb * sizeof(*p->width));
+    if (!p->first || !p->offset || !p->width) {
+        free(keys);
+        rb_packed_destroy(p);
+        return NULL;
+    }
+
+    // 2) Per-block bit widths and layout
+    size_t words = 0;
+    for (size_t b = 0; b < p->nblocks; b++) {
+        size_t start = b * RB_PACKED_BLOCK;
+        size_t len = rb_packed_block_len(p, b);
+        uint32_t range =
+            (uint32_t)keys[start + len - 1] - (uint32_t)keys[start];
+
+        unsigned width = 0;
+        while (range) {
+            width++;
+            range >>= 1;
+        }
+        p->first[b] = keys[start];
+        p->width[b] = (uint8_t)width;
+        p->offset[b] = (uint32_t)words;
+        words += (size_t)width * RB_PACKED_LANES;
+    }
+
+    p->data = calloc(words ? words : 1, sizeof(*p->data));
+    if (!p->data) {
+        free(keys);
+        rb_packed_destroy(p);
+        return NULL;
+    }
+
+    // 3) Encode; a short last block is padded with its largest key
+    for (size_t b = 0; b < p->nblocks; b++) {
+        if (p->width[b] == 0) {
+            continue;
+        }
+        size_t start = b * RB_PACKED_BLOCK;
+        size_t len = rb_packed_block_len(p, b);
+        uint32_t v[RB_PACKED_BLOCK];
+        for (size_t j = 0; j < RB_PACKED_BLOCK; j++) {
+            size_t k = start + (j < len ? j : len - 1);
+            v[j] = (uint32_t)keys[k] - (uint32_t)keys[start];
+        }
+        rb_packed_encode(v, p->width[b], p->data + p->offset[b]);
+    }
+
+    free(keys);
+    return p;
+}
+
+/**
+ * @brief Free a packed set.
+ */
+void rb_packed_destroy(RBPacked *p) {
+    if (!p) {
+        return;
+    }
+    free(p->first);
+    free(p->offset);
+    free(p->width);
+    free(p->data);
+    free(p);
+}
+
+/**
+ * @brief Check whether key is present.
+ *
+ *        1) The last block starting at or below key is the only one
+ *           that can hold it.
+ *        2) Decode it and count keys below key without branching;
+ *           that count is where key would be.
+ */
+int rb_packed_contains(const RBPacked *p, int key) {
+    // 1) Find the block
+    size_t b = rb_packed_upper_block(p, key, 0);
+    if (b == 0) {
+        return 0; // Smaller than every key
+    }
+    b--;
+
+    // 2) Decode and locate
+    int buf[RB_PACKED_BLOCK];
+    rb_packed_decode(p, b, buf);
+    size_t len = rb_packed_block_len(p, b);
+    size_t below = 0;
+    for (size_t i = 0; i < RB_PACKED_BLOCK; i++) {
+        below += buf[i] < key;
+    }
+    return below < len && buf[below] == key;
+}
+
+/**
+ * @brief Visit every key with lo <= key <= hi, in ascending order.
+ *
+ *        Copies of lo may end the block before the first block that
+ *        starts at lo, so the scan starts one block earlier.
+ */
+size_t rb_packed_range(const RBPacked *p, int lo, int hi,
+                       RBPackedVisitFn visit, void *ctx) {
+    size_t count = 0;
+    if (lo > hi) {
+        return 0;
+    }
+
+    size_t b = rb_packed_upper_block(p, lo, 1);
+    if (b > 0) {
+        b--;
+    }
+
+    int buf[RB_PACKED_BLOCK];
+    for (; b < p->nblocks && p->first[b] <= hi; b++) {
+        rb_packed_decode(p, b, buf);
+        size_t len = rb_packed_block_len(p, b);
+        for (size_t i = 0; i < len; i++) {
+            if (buf[i] < lo) {
+                continue;
+            }
+            if (buf[i] > hi) {
+                return count;
+            }
+            count++;
+            if (visit && visit(buf[i], ctx)) {
+                return count;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Total heap bytes used by the packed set.
+ */
+size_t rb_packed_bytes(const RBPacked *p) {
+    size_t words = 0;
+    for (size_t b = 0; b < p->nblocks; b++) {
+        words += (size_t)p->width[b] * RB_PACKED_LANES;
+    }
+    return sizeof(*p) +
+           p->nblocks * (sizeof(*p->first) + sizeof(*p->offset) +
+                         sizeof(*p->width)) +
+           words * sizeof(*p->data);
+}
@@ -0,0 +1,170 @@
+// src/rb_stats.c
+#define _POSIX_C_SOURCE 199309L
+
+#include "../include/rb_stats.h"
+#include <time.h>
+
+/**
+ * @brief Index of the highest set bit of v (v must be nonzero).
+ */
+static int rb_histogram_msb(uint64_t v) {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(v);
+#else
+    int msb = 0;
+    while (v >>= 1) {
+        msb++;
+    }
+    return msb;
+#endif
+}
+
+/**
+ * @brief Map a value to its bucket.
+ *
+ *        Values below RB_HIST_SUB_COUNT get a bucket each.  Larger
+ *        values use their top RB_HIST_SUB_BITS + 1 bits: the position
+ *        of the highest bit picks the power of two, the next bits pick
+ *        the linear sub-bucket inside it.
+ */
+static int rb_histogram_index(uint64_t v) {
+    if (v < RB_HIST_SUB_COUNT) {
+        return (int)v;
+    }
+    int msb = rb_histogram_msb(v);
+    int shift = msb - RB_HIST_SUB_BITS;
+    int sub = (int)((v >> shift) & (RB_HIST_SUB_COUNT - 1));
+    return (shift + 1) * RB_HIST_SUB_COUNT + sub;
+}
+
+/**
+ * @brief Largest value that maps to bucket i (inverse of the above).
+ */
+static uint64_t rb_histogram_upper(int i) {
+    if (i < RB_HIST_SUB_COUNT) {
+        return (uint64_t)i;
+    }
+    int shift = i / RB_HIST_SUB_COUNT - 1;
+    uint64_t sub = (uint64_t)(i % RB_HIST_SUB_COUNT);
+    uint64_t lower = (RB_HIST_SUB_COUNT + sub) << shift;
+    return lower + ((uint64_t)1 << shift) - 1;
+}
+
+/**
+ * @brief Record one sample.
+ */
+void rb_histogram_record(RBHistogram *h, uint64_t v) {
+    h->counts[rb_histogram_index(v)]++;
+    h->total++;
+    h->sum += v;
+    if (v > h->max) {
+        h->max = v;
+    }
+}
+
+/**
+ * @brief Record the same sample n times.
+ */
+void rb_histogram_record_n(RBHistogram *h, uint64_t v, uint64_t n) {
+    h->counts[rb_histogram_index(v)] += n;
+    h->total += n;
+    h->sum += v * n;
+    if (n > 0 && v > h->max) {
+        h->max = v;
+    }
+}
+
+/**
+ * @brief Return the value at percentile p (0..100).
+ *
+ *        Walk the buckets in order until the running count reaches
+ *        p% of all samples, and report that bucket's upper bound.
+ */
+uint64_t rb_histogram_percentile(const RBHistogram *h, double p) {
+    if (h->total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)((p / 100.0) * (double)h->total + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < RB_HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            uint64_t v = rb_histogram_upper(i);
+            return v < h->max ? v : h->max;
+        }
+    }
+    return h->max;
+}
+
+/**
+ * @brief Monotonic clock in nanoseconds.
+ */
+uint64_t rb_stats_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Start recording latency histograms for t.
+ */
+int rb_tree_stats_enable(RBTree *t) {
+#ifdef RB_TREE_STATS
+    if (!t->stats) {
+        t->stats = calloc(1, sizeof(RBStats));
+    }
+    return t->stats ? 0 : -1;
+#else
+    (void)t;
+    return -1;
+#endif
+}
+
+/**
+ * @brief Print per-operation latency percentiles and event counts.
+ */
+void rb_tree_stats_dump(RBTree *t, FILE *out) {
+    static const char *const op_names[RB_OP_COUNT] = {"insert", "delete",
+                                                      "search"};
+    static const char *const event_names[RB_TRACE_EVENT_COUNT] = {
+        "left rotate",   "right rotate",  "insert case 1",
+        "insert case 2", "insert case 3", "delete case 1",
+        "delete case 2", "delete case 3", "delete case 4"};
+
+    if (!t->stats) {
+        fprintf(out, "Statistics are disabled (build with `make STATS=1`)\n");
+        return;
+    }
+
+    fprintf(out, "%-8s %10s %8s %8s %8s %8s %10s  (ns)\n", "op", "count",
+            "mean", "p50", "p99", "p99.9", "max");
+    for (int i = 0; i < RB_OP_COUNT; i++) {
+        const RBHistogram *h = &t->stats->latency[i];
+        fprintf(out, "%-8s %10llu %8llu %8llu %8llu %8llu %10llu\n",
+                op_names[i], (unsigned long long)h->total,
+                (unsigned long long)(h->total ? h->sum / h->total : 0),
+                (unsigned long long)rb_histogram_percentile(h, 50.0),
+                (unsigned long long)rb_histogram_percentile(h, 99.0),
+                (unsigned long long)rb_histogram_percentile(h, 99.9),
+                (unsigned long long)h->max);
+    }
+
+    fprintf(out, "events:\n");
+    for (int i = 0; i < RB_TRACE_EVENT_COUNT; i++) {
+        fprintf(out, "  %-14s %llu\n", event_names[i],
+                (unsigned long long)t->stats->events[i]);
+    }
+}
+
+/**
+ * @brief Register (or clear, with NULL) the trace callback of t.
+ */
+void rb_tree_set_trace(RBTree *t, RBTraceFn fn, void *ctx) {
+    t->trace = fn;
+    t->trace_ctx = ctx;
+}
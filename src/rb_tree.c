@@ -1,5 +1,16 @@
 // src/rb_tree.c
 #include "../include/rb_tree.h"
+#include "../include/rb_stats.h"
+#include "../include/rb_tree_inline.h"
+#include <stdint.h>
+#include <string.h>
+
+// Hint the CPU to start loading p; harmless if unsupported.
+#if defined(__GNUC__)
+#define RB_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define RB_PREFETCH(p) ((void)(p))
+#endif
 
 /**
  * @brief Allocate and initialize an empty Red-Black Tree.
@@ -26,9 +37,12 @@ RBTree *rb_tree_create(void) {
 
     // 4) Empty tree: root = nil
     t->root = t->nil;
+    t->node_size = sizeof(RBNode);
     return t;
 }
 
+static void rb_tree_compact_end(RBTree *t);
+
 /**
  * @brief Recursively free all nodes in the subtree rooted at n.
  *
@@ -42,13 +56,14 @@ static void rb_tree_free_subtree(RBTree *t, RBNode *n) {
 
     rb_tree_free_subtree(t, n->left);
     rb_tree_free_subtree(t, n->right);
-    free(n);
+    rb_tree_free_node(t, n);
 }
 
 /**
  * @brief Destroy a Red-Black Tree and free its memory.
  *
  * 1) Recursively free all real nodes (post-order).
+ *    Compaction regions are freed along with their last node.
  * 2) Free the nil sentinel.
  * 3) Free the tree struct.
  *
@@ -59,40 +74,23 @@ void rb_tree_destroy(RBTree *t) {
         return;
     }
 
+    rb_tree_compact_end(t);
     rb_tree_free_subtree(t, t->root);
+    free(t->stats);
     free(t->nil);
     free(t);
 }
 
 /**
  * @brief Left-rotate the subtree rooted at x.
+ *        Fires the trace hook, then rotates with the inline helper.
  *
  * @param t  The Red-Black Tree.
  * @param x  Pivot node where rotation is applied.
  */
 void rb_tree_left_rotate(RBTree *t, RBNode *x) {
-    RBNode *y = x->right;    // 1) Set y
-    x->right = y->left;      // 2) Turn y's left subtree into x's right
-    if (y->left != t->nil) { // 3) Update parent pointer for that subtree
-        y->left->parent = x;
-    }
-
-    // 4) Link y to x's former parent
-    y->parent = x->parent;
-
-    if (x->parent == t->nil) {
-        // 5a) x was root
-        t->root = y;
-    } else if (x == x->parent->left) {
-        // 5b) x was left child
-        x->parent->left = y;
-    } else {
-        // 5c) x was right child
-        x->parent->right = y;
-    }
-
-    y->left = x;   // 6) Put x on y's left
-    x->parent = y; // 7) Update x's parent
+    RB_TRACE(t, RB_TRACE_LEFT_ROTATE, x);
+    rb_tree_left_rotate_inline(t, x);
 }
 
 static void rb_tree_insert_fixup(RBTree *t, RBNode *z);
@@ -100,49 +98,65 @@ static void rb_tree_insert_fixup(RBTree *t, RBNode *z);
 /**
  * @brief Right-rotate the subtree rooted at y.
  *        It is the mirror operation of left-rotation.
+ *        Fires the trace hook, then rotates with the inline helper.
  *
  * @param t  The Red-Black Tree.
  * @param y  Pivot node where rotation is applied.
  */
 void rb_tree_right_rotate(RBTree *t, RBNode *y) {
-    RBNode *x = y->left;      // 1) Set x
-    y->left = x->right;       // 2) Turn x's right subtree into y's left
-    if (x->right != t->nil) { // 3) Update parent pointer for that subtree
-        x->right->parent = y;
-    }
-
-    // 4) Link x to y's former parent
-    x->parent = y->parent;
-    if (y->parent == t->nil) {
-        // 5a) y was root
-        t->root = x;
-    } else if (y == y->parent->right) {
-        // 5b) y was right child
-        y->parent->right = x;
-    } else {
-        // 5c) y was left child
-        y->parent->left = x;
-    }
+    RB_TRACE(t, RB_TRACE_RIGHT_ROTATE, y);
+    rb_tree_right_rotate_inline(t, y);
+}
 
-    x->right = y;  // 6) Put y on x's right
-    y->parent = x; // 7) Update y's parent
+/**
+ * @brief Refresh augmented summaries from n up to the root.
+ *        Used after a structural change that rotations don't cover.
+ *
+ * @param t  The Red-Black Tree.
+ * @param n  The lowest node whose subtree changed (may be nil).
+ */
+static void rb_tree_augment_path(RBTree *t, RBNode *n) {
+    if (!t->augment) {
+        return;
+    }
+    while (n != t->nil) {
+        t->augment(t, n);
+        n = n->parent;
+    }
 }
 
 /**
  * @brief Insert a new node into the Red-Black Tree.
- *         This function doesn't implement the fixup logic,
- *         which is defined at rb_tree_insert_fixup().
+ *         Allocates the node and hands it to rb_tree_insert_node().
  *
  * @param t    The Red-Black Tree.
  * @param key  The key to insert.
  */
 void rb_tree_insert(RBTree *t, int key) {
-    // 1) Allocate and initialize the new node z
+    RB_STATS_START(t, t0);
+
     RBNode *z = calloc(1, sizeof(RBNode));
     if (!z) {
         return; // Handle allocation failure
     }
     z->key = key;
+    rb_tree_insert_node(t, z);
+
+    RB_STATS_STOP(t, RB_OP_INSERT, t0);
+}
+
+/**
+ * @brief Link an allocated node into the Red-Black Tree.
+ *         This function doesn't implement the fixup logic,
+ *         which is defined at rb_tree_insert_fixup().
+ *
+ * @param t  The Red-Black Tree.
+ * @param z  The node to link in (z->key already set).
+ */
+void rb_tree_insert_node(RBTree *t, RBNode *z) {
+    t->size++;
+
+    // 1) Initialize the new node z
     z->color = RED; // New nodes are always red initially
     z->left = t->nil;
     z->right = t->nil;
@@ -175,7 +189,10 @@ void rb_tree_insert(RBTree *t, int key) {
         y->right = z;
     }
 
-    // 4) Call fix up and red-black tree property violation
+    // 4) z's ancestors gained a descendant: refresh their summaries
+    rb_tree_augment_path(t, z);
+
+    // 5) Call fix up and red-black tree property violation
     rb_tree_insert_fixup(t, z);
 }
 
@@ -196,6 +213,7 @@ static void rb_tree_insert_fixup(RBTree *t, RBNode *z) {
             y = z->parent->parent->right; // uncle (right)
             if (y->color == RED) {
                 // Case 1: Uncle is red -> recolor
+                RB_TRACE(t, RB_TRACE_INSERT_CASE1, z);
                 z->parent->color = BLACK;
                 y->color = BLACK;
                 z->parent->parent->color = RED;
@@ -204,10 +222,12 @@ static void rb_tree_insert_fixup(RBTree *t, RBNode *z) {
                 if (z == z->parent->right) {
                     // Case 2: z is right child -> left rotate
                     // to transform this case into Case 3
+                    RB_TRACE(t, RB_TRACE_INSERT_CASE2, z);
                     z = z->parent;
                     rb_tree_left_rotate(t, z);
                 }
                 // Case 3: z is left child -> right rotate
+                RB_TRACE(t, RB_TRACE_INSERT_CASE3, z);
                 z->parent->color = BLACK;
                 z->parent->parent->color = RED;
                 rb_tree_right_rotate(t, z->parent->parent);
@@ -217,6 +237,7 @@ static void rb_tree_insert_fixup(RBTree *t, RBNode *z) {
             y = z->parent->parent->left; // uncle (left)
             if (y->color == RED) {
                 // Case 1': Uncle is red -> recolor
+                RB_TRACE(t, RB_TRACE_INSERT_CASE1, z);
                 z->parent->color = BLACK;
                 y->color = BLACK;
                 z->parent->parent->color = RED;
@@ -224,10 +245,12 @@ static void rb_tree_insert_fixup(RBTree *t, RBNode *z) {
             } else {
                 if (z == z->parent->left) {
                     // Case 2'
+                    RB_TRACE(t, RB_TRACE_INSERT_CASE2, z);
                     z = z->parent;
                     rb_tree_right_rotate(t, z);
                 }
                 // Case 3'
+                RB_TRACE(t, RB_TRACE_INSERT_CASE3, z);
                 z->parent->color = BLACK;
                 z->parent->parent->color = RED;
                 rb_tree_left_rotate(t, z->parent->parent);
@@ -279,55 +302,68 @@ static void rb_tree_delete_fixup(RBTree *T, RBNode *x);
 
 /**
  * @brief Delete a node with the given key from the Red-Black Tree.
+ *        Finds the node, unlinks it with rb_tree_delete_node()
+ *        and frees it.
+ *
+ * @param t    The Red-Black Tree.
+ * @param key  The key of the node to delete.
+ *
+ * @return 1 if a node was deleted, 0 if the key was not found.
+ */
+int rb_tree_delete(RBTree *t, int key) {
+    RB_STATS_START(t, t0);
+
+    // Untimed lookup, so a delete is not also recorded as a search
+    RBNode *z = rb_tree_search_inline(t, key);
+    if (z != t->nil) {
+        rb_tree_delete_node(t, z);
+
+        // Don't forget to free the memory! >_<
+        rb_tree_free_node(t, z);
+    }
+
+    RB_STATS_STOP(t, RB_OP_DELETE, t0);
+    return z != t->nil;
+}
+
+/**
+ * @brief Unlink node z from the Red-Black Tree.
  *        This function implements the deletion logic and calls
  *        rb_tree_delete_fixup() to maintain properties.
  *
- *        1) Find the node z to delete.
- *        2) Prepare for deletion by determining the node y to actually delete.
- *        3) If z has no children or only one child,
+ *        1) Prepare for deletion by determining the node y to actually delete.
+ *        2) If z has no children or only one child,
  *           transplant it with its child.
- *        4) If z has two children, find its successor y,
+ *        3) If z has two children, find its successor y,
  *           transplant z with y, and copy y's left child to z's left.
+ *        4) Refresh augmented summaries above the lowest changed node.
  *        5) If the original color of y was black,
  *           fix up the tree to maintain Red-Black properties.
- *        6) Free the memory of the deleted node z.
  *
- * @param t    The Red-Black Tree.
- * @param key  The key of the node to delete.
+ *        The node is not freed; that is up to the caller.
+ *
+ * @param t  The Red-Black Tree.
+ * @param z  The node to unlink.
  */
-void rb_tree_delete(RBTree *t, int key) {
-    RBNode *z = t->root;
-
-    // 1) Find node z (the node to delete)
-    while (z != t->nil && z->key != key) {
-        if (key < z->key) {
-            // Go left if key is less than z's key
-            z = z->left;
-        } else {
-            // Go right otherwise
-            z = z->right;
-        }
-    }
-    if (z == t->nil) {
-        // Key not found, nothing to delete
-        return;
-    }
+void rb_tree_delete_node(RBTree *t, RBNode *z) {
+    t->size--;
 
-    // 2) Prepare for deletion
+    // 1) Prepare for deletion
     RBNode *y = z; // Node to actually delete
     Color y_original_color = y->color;
     RBNode *x;
+    RBNode *changed = z->parent; // Lowest node whose subtree changed
 
     if (z->left == t->nil) {
-        // 3a-1) z only has right child or no children
+        // 2a-1) z only has right child or no children
         x = z->right;
         rb_tree_transplant(t, z, z->right);
     } else if (z->right == t->nil) {
-        // 3a-2) z only has left child or no children
+        // 2a-2) z only has left child or no children
         x = z->left;
         rb_tree_transplant(t, z, z->left);
     } else {
-        // 3b) z has two children.
+        // 2b) z has two children.
         //     find successor y = min(z->right)
         y = rb_tree_minimum(t, z->right);
         y_original_color = y->color;
@@ -337,7 +373,9 @@ void rb_tree_delete(RBTree *t, int key) {
             // If the successor is a direct child of z,
             // we can just link x to y.
             x->parent = y;
+            changed = y;
         } else {
+            changed = y->parent;
             // If not, transplant y with its right child and
             // link y's right child to y's parent.
             rb_tree_transplant(t, y, y->right);
@@ -352,15 +390,17 @@ void rb_tree_delete(RBTree *t, int key) {
         y->color = z->color; // Copy color from z
     }
 
-    // 4) Fixup if we removed a black node.
+    // 4) Refresh summaries from the lowest changed node up to the root
+    rb_tree_augment_path(t, changed);
+
+    // 5) Fixup if we removed a black node.
     //    If we deleted a black node, the black height property may be violated.
     if (y_original_color == BLACK) {
         rb_tree_delete_fixup(t, x);
     }
 
-    // 5) Free the deleted node.
-    //    Don't forget to free the memory! >_<
-    free(z);
+    // 6) Mark z unlinked, so a running compaction pass skips its slot
+    z->parent = NULL;
 }
 
 /**
@@ -387,6 +427,7 @@ static void rb_tree_delete_fixup(RBTree *t, RBNode *x) {
 
             if (w->color == RED) {
                 // 1) If sibling is red, rotate and make sibling black
+                RB_TRACE(t, RB_TRACE_DELETE_CASE1, x);
                 w->color = BLACK;
                 x->parent->color = RED;
                 rb_tree_left_rotate(t, x->parent);
@@ -394,18 +435,21 @@ static void rb_tree_delete_fixup(RBTree *t, RBNode *x) {
             }
             if (w->left->color == BLACK && w->right->color == BLACK) {
                 // 2) If sibling has two black-colored children nodes
+                RB_TRACE(t, RB_TRACE_DELETE_CASE2, x);
                 w->color = RED;
                 x = x->parent;
             } else {
                 if (w->right->color == BLACK) {
                     // 3) If w->left is red and w->right is black,
                     //    rotate right and recolor
+                    RB_TRACE(t, RB_TRACE_DELETE_CASE3, x);
                     w->left->color = BLACK;
                     w->color = RED;
                     rb_tree_right_rotate(t, w);
                     w = x->parent->right;
                 }
                 // 4) If w->right is red, rotate left and recolor
+                RB_TRACE(t, RB_TRACE_DELETE_CASE4, x);
                 w->color = x->parent->color;
                 x->parent->color = BLACK;
                 w->right->color = BLACK;
@@ -418,6 +462,7 @@ static void rb_tree_delete_fixup(RBTree *t, RBNode *x) {
 
             if (w->color == RED) {
                 // 1') If sibling is red, rotate and make sibling black
+                RB_TRACE(t, RB_TRACE_DELETE_CASE1, x);
                 w->color = BLACK;
                 x->parent->color = RED;
                 rb_tree_right_rotate(t, x->parent);
@@ -425,18 +470,21 @@ static void rb_tree_delete_fixup(RBTree *t, RBNode *x) {
             }
             if (w->right->color == BLACK && w->left->color == BLACK) {
                 // 2') If sibling has two black-colored children nodes
+                RB_TRACE(t, RB_TRACE_DELETE_CASE2, x);
                 w->color = RED;
                 x = x->parent;
             } else {
                 if (w->left->color == BLACK) {
                     // 3') If w->right is red and w->left is black,
                     //     rotate left and recolor
+                    RB_TRACE(t, RB_TRACE_DELETE_CASE3, x);
                     w->right->color = BLACK;
                     w->color = RED;
                     rb_tree_left_rotate(t, w);
                     w = x->parent->left;
                 }
                 // 4') If w->left is red, rotate right and recolor
+                RB_TRACE(t, RB_TRACE_DELETE_CASE4, x);
                 w->color = x->parent->color;
                 x->parent->color = BLACK;
                 w->left->color = BLACK;
@@ -453,6 +501,7 @@ static void rb_tree_delete_fixup(RBTree *t, RBNode *x) {
 
 /**
  * @brief Search for a node with the given key in the Red-Black Tree.
+ *        Times the lookup when statistics are enabled.
  *
  * @param t    The Red-Black Tree.
  * @param key  The key to search for.
@@ -460,17 +509,372 @@ static void rb_tree_delete_fixup(RBTree *t, RBNode *x) {
  * @return Pointer to the found node, or t->nil if not found.
  */
 RBNode *rb_tree_search(RBTree *t, int key) {
-    RBNode *x = t->root;
-    while (x != t->nil && x->key != key) {
-        if (key < x->key) {
-            // If key is less, go left
-            x = x->left;
+    RB_STATS_START(t, t0);
+    RBNode *x = rb_tree_search_inline(t, key);
+    RB_STATS_STOP(t, RB_OP_SEARCH, t0);
+    return x;
+}
+
+/**
+ * @brief Search for many keys in the Red-Black Tree at once.
+ *
+ *        1) Split the keys into groups of RB_SEARCH_BATCH.
+ *        2) Start every lookup of the group at the root.
+ *        3) In each round, step every unfinished lookup down one level
+ *           and prefetch the child it lands on.  By the time the round
+ *           comes back to it, the child is (hopefully) in cache.
+ *        4) Stop when every lookup hit its key or nil.
+ *
+ * @param t     The Red-Black Tree.
+ * @param keys  The keys to search for.
+ * @param n     Number of keys.
+ * @param out   Receives the found node (or t->nil) for each key.
+ */
+void rb_tree_search_batch(RBTree *t, const int *keys, size_t n, RBNode **out) {
+    RB_STATS_START(t, t0);
+    for (size_t base = 0; base < n; base += RB_SEARCH_BATCH) {
+        // 1) Current group: keys[base .. base + width)
+        size_t width = n - base;
+        if (width > RB_SEARCH_BATCH) {
+            width = RB_SEARCH_BATCH;
+        }
+        const int *k = keys + base;
+        RBNode **cur = out + base;
+
+        // 2) Everyone starts at the root
+        for (size_t i = 0; i < width; i++) {
+            cur[i] = t->root;
+        }
+
+        // 3) Advance all lookups one level per round
+        size_t active = width;
+        while (active) {
+            active = 0;
+            for (size_t i = 0; i < width; i++) {
+                RBNode *x = cur[i];
+                if (x == t->nil || x->key == k[i]) {
+                    // 4) This lookup is done
+                    continue;
+                }
+                x = (k[i] < x->key) ? x->left : x->right;
+                RB_PREFETCH(x);
+                cur[i] = x;
+                active++;
+            }
+        }
+    }
+    RB_STATS_STOP_N(t, RB_OP_SEARCH, t0, n);
+}
+
+/**
+ * @brief Recursive worker for rb_tree_range().
+ *
+ *        Equal keys may sit on either side of each other, so the left
+ *        subtree is entered while n->key >= lo and the right one while
+ *        n->key <= hi.
+ *
+ * @return 1 if visit asked to stop, 0 otherwise.
+ */
+static int rb_tree_range_subtree(RBTree *t, RBNode *n, int lo, int hi,
+                                 RBVisitFn visit, void *ctx, size_t *count) {
+    if (n == t->nil) {
+        return 0;
+    }
+
+    if (n->key >= lo &&
+        rb_tree_range_subtree(t, n->left, lo, hi, visit, ctx, count)) {
+        return 1;
+    }
+    if (n->key >= lo && n->key <= hi) {
+        (*count)++;
+        if (visit && visit(n, ctx)) {
+            return 1;
+        }
+    }
+    if (n->key <= hi) {
+        return rb_tree_range_subtree(t, n->right, lo, hi, visit, ctx, count);
+    }
+    return 0;
+}
+
+/**
+ * @brief Visit every node with lo <= key <= hi, in key order.
+ *
+ * @param t      The Red-Black Tree.
+ * @param lo     Smallest key to report.
+ * @param hi     Largest key to report.
+ * @param visit  Called for each node in range (may be NULL).
+ * @param ctx    Passed through to visit.
+ *
+ * @return The number of nodes visited.
+ */
+size_t rb_tree_range(RBTree *t, int lo, int hi, RBVisitFn visit, void *ctx) {
+    size_t count = 0;
+    if (lo <= hi) {
+        rb_tree_range_subtree(t, t->root, lo, hi, visit, ctx, &count);
+    }
+    return count;
+}
+
+/**
+ * @brief Return the region holding node n, or NULL if n was malloc'd.
+ *
+ * @param t     The Red-Black Tree.
+ * @param n     The node to look up.
+ * @param prev  Receives the link pointing at the region (for unlinking).
+ */
+static RBRegion *rb_tree_find_region(RBTree *t, RBNode *n, RBRegion ***prev) {
+    uintptr_t addr = (uintptr_t)n;
+    for (RBRegion **link = &t->regions; *link; link = &(*link)->next) {
+        RBRegion *r = *link;
+        uintptr_t base = (uintptr_t)r->base;
+        if (addr >= base && addr < base + r->cap * t->node_size) {
+            *prev = link;
+            return r;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Release a node's memory, either to malloc or to its region.
+ *
+ * @param t  The Red-Black Tree.
+ * @param n  The node (already unlinked or about to be dropped).
+ */
+void rb_tree_free_node(RBTree *t, RBNode *n) {
+    RBRegion **prev;
+    RBRegion *r = rb_tree_find_region(t, n, &prev);
+    if (!r) {
+        free(n);
+        return;
+    }
+
+    // The slot is not reused; mark it dead for the sweep, and drop the
+    // region once its last node is gone.  While a pass runs, regions
+    // are kept (the pass walks them) and released when it ends.
+    n->parent = NULL;
+    if (--r->live == 0 && !t->compacting) {
+        *prev = r->next;
+        free(r->base);
+        free(r);
+    }
+}
+
+/**
+ * @brief End the running compaction pass, if any (finished or not).
+ *
+ * Releases every region that no longer holds a node, including the
+ * pass's own if nothing moved there stayed.  Regions still holding
+ * nodes are released like any other once those are all gone.
+ *
+ * @param t  The Red-Black Tree.
+ */
+static void rb_tree_compact_end(RBTree *t) {
+    if (!t->compacting) {
+        return;
+    }
+    t->compacting = NULL;
+    t->sweeping = NULL;
+
+    RBRegion **link = &t->regions;
+    while (*link) {
+        RBRegion *r = *link;
+        if (r->live == 0) {
+            *link = r->next;
+            free(r->base);
+            free(r);
         } else {
-            // If key is greater or equal, go right
-            x = x->right;
+            link = &r->next;
         }
     }
-    return x;
+}
+
+/**
+ * @brief Return 1 if n already sits in the region of the running pass.
+ */
+static int rb_tree_in_pass(RBTree *t, RBNode *n) {
+    uintptr_t addr = (uintptr_t)n;
+    uintptr_t base = (uintptr_t)t->compacting->base;
+    return addr >= base && addr < base + t->compacting->cap * t->node_size;
+}
+
+/**
+ * @brief Move node n to the memory at m.
+ *
+ *        1) Copy the whole node (including any embedding struct).
+ *        2) Point the parent (or the root) at the copy.
+ *        3) Point the children back at the copy.
+ *        4) Release the old location.
+ *
+ * @param t  The Red-Black Tree.
+ * @param n  The node to move (must not be nil).
+ * @param m  Where it goes (t->node_size bytes).
+ */
+static void rb_tree_relocate(RBTree *t, RBNode *n, RBNode *m) {
+    // 1) Copy
+    memcpy(m, n, t->node_size);
+
+    // 2) Relink from above
+    if (m->parent == t->nil) {
+        t->root = m;
+    } else if (m->parent->left == n) {
+        m->parent->left = m;
+    } else {
+        m->parent->right = m;
+    }
+
+    // 3) Relink from below
+    if (m->left != t->nil) {
+        m->left->parent = m;
+    }
+    if (m->right != t->nil) {
+        m->right->parent = m;
+    }
+
+    // 4) Drop the old copy
+    rb_tree_free_node(t, n);
+}
+
+/**
+ * @brief Move node n into the next free slot of the compaction region.
+ *
+ * @param t  The Red-Black Tree.
+ * @param n  The node to move (must not be nil).
+ */
+static void rb_tree_compact_move(RBTree *t, RBNode *n) {
+    RBRegion *r = t->compacting;
+    RBNode *m = (RBNode *)(r->base + t->compact_fill * t->node_size);
+    t->compact_fill++;
+    r->live++;
+    rb_tree_relocate(t, n, m);
+}
+
+/**
+ * @brief Run part of a compaction pass.
+ *
+ *        1) If no pass is running, allocate a region of t->size slots
+ *           and move the root into slot 0.
+ *        2) The region doubles as the BFS queue: slots before
+ *           compact_scan have had their children moved, slots between
+ *           compact_scan and compact_fill are waiting for it.
+ *        3) Move children of waiting slots until the budget runs out.
+ *           The tree may have changed since the last call, so slots
+ *           whose node was deleted are skipped, children already in
+ *           the region (brought there by a rotation) are left alone,
+ *           and moving stops when the region is full.
+ *        4) When the scan catches up with the fill, sweep the older
+ *           regions slot by slot.  Nodes still living there (inserted
+ *           or rotated under an already scanned slot, or not reached
+ *           because the region filled up) go to the remaining free
+ *           slots, then to the heap.
+ *        5) When every older region is empty, the pass is done and
+ *           they are all released.
+ *
+ * @param t       The Red-Black Tree.
+ * @param budget  Maximum number of nodes to move or old slots to check
+ *                (a slot's two children are moved together, so one more
+ *                may slip through).
+ *
+ * @return 1 when done, 0 if more work remains, -1 on allocation failure.
+ */
+int rb_tree_compact_step(RBTree *t, size_t budget) {
+    // 1) Start a new pass
+    if (!t->compacting) {
+        if (t->root == t->nil) {
+            return 1; // Nothing to compact
+        }
+
+        RBRegion *r = calloc(1, sizeof(RBRegion));
+        if (!r) {
+            return -1;
+        }
+        // Zeroed, so slots never filled read as dead (parent NULL)
+        r->base = calloc(t->size, t->node_size);
+        if (!r->base) {
+            free(r);
+            return -1;
+        }
+        r->cap = t->size;
+        r->next = t->regions;
+        t->regions = r;
+
+        t->compacting = r;
+        t->compact_scan = 0;
+        t->compact_fill = 0;
+        t->sweeping = r->next; // Every other region is older
+        t->sweep_slot = 0;
+        rb_tree_compact_move(t, t->root);
+    }
+
+    // 2-3) Breadth-first: move the children of each waiting slot
+    RBRegion *r = t->compacting;
+    size_t moved = 0;
+    while (moved < budget && t->compact_scan < t->compact_fill) {
+        RBNode *n = (RBNode *)(r->base + t->compact_scan * t->node_size);
+        t->compact_scan++;
+        if (!n->parent) {
+            continue; // Deleted since it was moved
+        }
+        RBNode *kids[2] = {n->left, n->right};
+        for (int i = 0; i < 2; i++) {
+            if (kids[i] != t->nil && !rb_tree_in_pass(t, kids[i]) &&
+                t->compact_fill < r->cap) {
+                rb_tree_compact_move(t, kids[i]);
+                moved++;
+            }
+        }
+    }
+
+    if (t->compact_scan < t->compact_fill) {
+        return 0;
+    }
+
+    // 4) Sweep what is left in the older regions
+    while (moved < budget && t->sweeping) {
+        RBRegion *old = t->sweeping;
+        if (old->live == 0 || t->sweep_slot == old->cap) {
+            t->sweeping = old->next;
+            t->sweep_slot = 0;
+            continue;
+        }
+        RBNode *n = (RBNode *)(old->base + t->sweep_slot * t->node_size);
+        moved++;
+        if (!n->parent) {
+            t->sweep_slot++;
+            continue; // Moved, deleted or never filled
+        }
+        if (t->compact_fill < r->cap) {
+            rb_tree_compact_move(t, n);
+        } else {
+            RBNode *m = malloc(t->node_size);
+            if (!m) {
+                return -1; // Retried by the next call
+            }
+            rb_tree_relocate(t, n, m);
+        }
+        t->sweep_slot++;
+    }
+
+    if (t->sweeping) {
+        return 0;
+    }
+
+    // 5) Pass complete: release the emptied regions
+    rb_tree_compact_end(t);
+    return 1;
+}
+
+/**
+ * @brief Run a whole compaction pass at once.
+ *        Finishes the running pass, if any, or runs a new one.
+ *
+ * @param t  The Red-Black Tree.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+int rb_tree_compact(RBTree *t) {
+    return rb_tree_compact_step(t, SIZE_MAX) < 0 ? -1 : 0;
 }
 
 /**
@@ -0,0 +1,292 @@
+// src/rb_tree_td.c
+#include "../include/rb_tree_td.h"
+
+/**
+ * @brief Allocate and initialize an empty top-down Red-Black Tree.
+ */
+RBTDTree *rb_td_tree_create(void) {
+    // 1) Allocate the tree structure
+    RBTDTree *t = calloc(1, sizeof(RBTDTree));
+    if (!t) {
+        return NULL;
+    }
+
+    // 2) Create the nil sentinel node
+    t->nil = calloc(1, sizeof(RBTDNode));
+    if (!t->nil) {
+        free(t);
+        return NULL;
+    }
+
+    // 3) Initialize sentinel: always black, points to itself
+    t->nil->color = BLACK;
+    t->nil->child[0] = t->nil;
+    t->nil->child[1] = t->nil;
+
+    // 4) Empty tree: root = nil
+    t->root = t->nil;
+    return t;
+}
+
+/**
+ * @brief Recursively free all nodes in the subtree rooted at n.
+ *
+ * @param t  The top-down Red-Black Tree (for its nil sentinel).
+ * @param n  Current subtree root (skip if nil).
+ */
+static void rb_td_tree_free_subtree(RBTDTree *t, RBTDNode *n) {
+    if (n == t->nil) {
+        return;
+    }
+
+    rb_td_tree_free_subtree(t, n->child[0]);
+    rb_td_tree_free_subtree(t, n->child[1]);
+    free(n);
+}
+
+/**
+ * @brief Destroy a top-down Red-Black Tree and free its memory.
+ *
+ * @param t  Pointer to the RBTDTree to destroy.
+ */
+void rb_td_tree_destroy(RBTDTree *t) {
+    if (!t) {
+        return;
+    }
+
+    rb_td_tree_free_subtree(t, t->root);
+    free(t->nil);
+    free(t);
+}
+
+/**
+ * @brief Rotate the subtree rooted at n once in direction dir.
+ *
+ * The child on the opposite side (n->child[!dir]) becomes the new
+ * subtree root.  The new root is colored black and n red, which is
+ * exactly the recoloring both top-down passes need after a rotation.
+ *
+ * @param n    Subtree root (must not be nil).
+ * @param dir  0 = rotate left, 1 = rotate right.
+ *
+ * @return The new subtree root.
+ */
+static RBTDNode *rb_td_single_rotate(RBTDNode *n, int dir) {
+    RBTDNode *s = n->child[!dir];
+    n->child[!dir] = s->child[dir];
+    s->child[dir] = n;
+
+    n->color = RED;
+    s->color = BLACK;
+    return s;
+}
+
+/**
+ * @brief Double rotation: rotate n->child[!dir] the other way first,
+ *        then rotate n in direction dir.
+ *
+ * @param n    Subtree root (must not be nil).
+ * @param dir  0 = rotate left, 1 = rotate right.
+ *
+ * @return The new subtree root.
+ */
+static RBTDNode *rb_td_double_rotate(RBTDNode *n, int dir) {
+    n->child[!dir] = rb_td_single_rotate(n->child[!dir], !dir);
+    return rb_td_single_rotate(n, dir);
+}
+
+/**
+ * @brief Insert a key in a single top-down pass.
+ *
+ *        1) Walk down from the root keeping the great-grandparent,
+ *           grandparent and parent of the current node q.
+ *        2) If q has two red children, flip colors (split the 4-node).
+ *        3) If that made q and its parent both red, rotate at the
+ *           grandparent (single or double rotation).
+ *        4) When we fall off the tree, hang the new red node there and
+ *           apply 3) once more.
+ *
+ * @param t    The top-down Red-Black Tree.
+ * @param key  The key to insert.
+ */
+void rb_td_tree_insert(RBTDTree *t, int key) {
+    // 1) Allocate and initialize the new red node z
+    RBTDNode *z = calloc(1, sizeof(RBTDNode));
+    if (!z) {
+        return; // Handle allocation failure
+    }
+    z->key = key;
+    z->color = RED;
+    z->child[0] = t->nil;
+    z->child[1] = t->nil;
+
+    if (t->root == t->nil) {
+        // tree was empty
+        z->color = BLACK;
+        t->root = z;
+        return;
+    }
+
+    // 2) A fake black root above the real one, so rotations at the real
+    //    root need no special case.
+    RBTDNode head = {0, BLACK, {t->nil, t->root}};
+    RBTDNode *gg = &head; // great-grandparent
+    RBTDNode *g = NULL;   // grandparent
+    RBTDNode *p = NULL;   // parent
+    RBTDNode *q = t->root;
+    int dir = 0, last = 0;
+
+    for (;;) {
+        if (q == t->nil) {
+            // 3a) Fell off the tree: link z here
+            p->child[dir] = q = z;
+        } else if (q->child[0]->color == RED && q->child[1]->color == RED) {
+            // 3b) Color flip: split the 4-node on the way down
+            q->color = RED;
+            q->child[0]->color = BLACK;
+            q->child[1]->color = BLACK;
+        }
+
+        // 4) Red-red violation between q and p: rotate at grandparent.
+        //    A red parent is never the root, so g is always valid here.
+        if (q->color == RED && p && p->color == RED) {
+            int dir2 = gg->child[1] == g;
+            if (q == p->child[last]) {
+                // q and p lean the same way -> single rotation
+                gg->child[dir2] = rb_td_single_rotate(g, !last);
+            } else {
+                // zig-zag -> double rotation
+                gg->child[dir2] = rb_td_double_rotate(g, !last);
+            }
+        }
+
+        if (q == z) {
+            break;
+        }
+
+        // 5) Step down; equal keys go right
+        last = dir;
+        dir = q->key <= key;
+        if (g) {
+            gg = g;
+        }
+        g = p;
+        p = q;
+        q = q->child[dir];
+    }
+
+    // Update root and keep it black (Don't forget this! >_<)
+    t->root = head.child[1];
+    t->root->color = BLACK;
+}
+
+/**
+ * @brief Delete a key in a single top-down pass.
+ *
+ *        1) Walk down towards the in-order predecessor of the key,
+ *           remembering the last node f whose key matched.
+ *        2) On the way, make sure the current node q (or its child on
+ *           the search path) is red, by:
+ *           - rotating a red sibling-side child up, or
+ *           - color flipping with the sibling s, or
+ *           - rotating at the grandparent when s has a red child.
+ *        3) At the bottom q is red, so it can be unlinked without
+ *           breaking the black height; its key is copied into f.
+ *
+ * @param t    The top-down Red-Black Tree.
+ * @param key  The key of the node to delete.
+ */
+void rb_td_tree_delete(RBTDTree *t, int key) {
+    if (t->root == t->nil) {
+        return;
+    }
+
+    RBTDNode head = {0, BLACK, {t->nil, t->root}};
+    RBTDNode *q = &head; // current node
+    RBTDNode *p = NULL;  // parent
+    RBTDNode *g = NULL;  // grandparent
+    RBTDNode *f = NULL;  // matched node
+    int dir = 1;
+
+    // 1) Search and push a red node down
+    while (q->child[dir] != t->nil) {
+        int last = dir;
+
+        g = p;
+        p = q;
+        q = q->child[dir];
+        dir = q->key < key;
+
+        if (q->key == key) {
+            f = q;
+        }
+
+        if (q->color == RED || q->child[dir]->color == RED) {
+            continue;
+        }
+
+        if (q->child[!dir]->color == RED) {
+            // 2a) Red child off the path: rotate it above q
+            p = p->child[last] = rb_td_single_rotate(q, dir);
+        } else {
+            RBTDNode *s = p->child[!last]; // sibling of q
+            if (s == t->nil) {
+                continue;
+            }
+
+            if (s->child[0]->color == BLACK && s->child[1]->color == BLACK) {
+                // 2b) Sibling has two black children: color flip
+                p->color = BLACK;
+                s->color = RED;
+                q->color = RED;
+            } else {
+                // 2c) Sibling has a red child: rotate at the grandparent
+                int dir2 = g->child[1] == p;
+                if (s->child[last]->color == RED) {
+                    g->child[dir2] = rb_td_double_rotate(p, last);
+                } else {
+                    g->child[dir2] = rb_td_single_rotate(p, last);
+                }
+
+                // Fix colors of the new subtree root and its children
+                q->color = RED;
+                g->child[dir2]->color = RED;
+                g->child[dir2]->child[0]->color = BLACK;
+                g->child[dir2]->child[1]->color = BLACK;
+            }
+        }
+    }
+
+    // 3) Replace and unlink
+    if (f) {
+        f->key = q->key;
+        p->child[p->child[1] == q] = q->child[q->child[0] == t->nil];
+        free(q);
+    }
+
+    // Update root and keep it black (Don't forget this! >_<)
+    t->root = head.child[1];
+    t->root->color = BLACK;
+}
+
+/**
+ * @brief Search for a node with the given key in the top-down tree.
+ *
+ * @param t    The top-down Red-Black Tree.
+ * @param key  The key to search for.
+ *
+ * @return Pointer to the found node, or t->nil if not found.
+ */
+RBTDNode *rb_td_tree_search(RBTDTree *t, int key) {
+    RBTDNode *x = t->root;
+    while (x != t->nil && x->key != key) {
+        if (key < x->key) {
+            // If key is less, go left
+            x = x->child[0];
+        } else {
+            // If key is greater, go right
+            x = x->child[1];
+        }
+    }
+    return x;
+}
@@ -0,0 +1,631 @@
+// src/server.c
+#define _GNU_SOURCE
+
+#include "../include/server.h"
+#include "../include/rb_protocol.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define RB_SERVER_MAX_EVENTS 64
+#define RB_SERVER_IN_SZ (64 * 1024)
+// Stop taking requests from a client once its unsent responses, plus
+// the most its parsed requests can still add, reach this.  The limit
+// can be exceeded by at most one response.
+#define RB_SERVER_OUT_HIGH (1024 * 1024)
+
+/**
+ * @struct RBConn
+ * @brief One client connection.
+ */
+typedef struct RBConn {
+    struct RBConn *prev, *next;          // All open connections.
+    int fd;                              // Client socket.
+    uint32_t events;                     // Current epoll interest.
+    int closing;                         // Peer gone; close after tick.
+    int eof;                             // Peer done sending (half-close).
+    int touched;                         // Already in the touched list.
+    size_t in_len;                       // Bytes buffered in in[].
+    unsigned char in[RB_SERVER_IN_SZ];   // Partial request frames.
+    unsigned char *out;                  // Responses not yet sent.
+    size_t out_off, out_len, out_cap;    // Sent / filled / allocated.
+    size_t out_promised;                 // Most that queued requests add.
+} RBConn;
+
+/**
+ * @struct RBPending
+ * @brief A parsed request waiting for the end of the tick.
+ */
+typedef struct {
+    RBConn *conn;
+    RBRequest req;
+} RBPending;
+
+/**
+ * @struct RBServer
+ * @brief Event loop state.
+ */
+typedef struct {
+    RBTree *t;
+    int epfd;                     // epoll instance.
+    int lfd;                      // Listening socket.
+    int spare_fd;                 // Reserve fd for running out of them.
+    RBConn *conns;                // All open connections.
+    RBPending *batch;             // Requests of the current tick.
+    size_t batch_len, batch_cap;
+    RBConn **touched;             // Connections to flush or close.
+    size_t touched_len, touched_cap;
+    RBConn **carry;               // Frames held back, parse next tick.
+    size_t carry_len, carry_cap;
+    int *keys;                    // Scratch for batched searches.
+    size_t keys_cap;
+    RBNode **found;
+    size_t found_cap;
+} RBServer;
+
+static volatile sig_atomic_t rb_server_stop;
+
+static void rb_server_on_signal(int sig) {
+    (void)sig;
+    rb_server_stop = 1;
+}
+
+/**
+ * @brief Grow a dynamic array to hold at least need elements.
+ *
+ * @return 0 on success, -1 on allocation failure (array untouched).
+ */
+static int rb_server_reserve(void **arr, size_t *cap, size_t need,
+                             size_t elem) {
+    if (need <= *cap) {
+        return 0;
+    }
+    size_t cap2 = *cap ? *cap : 64;
+    while (cap2 < need) {
+        cap2 *= 2;
+    }
+    void *p = realloc(*arr, cap2 * elem);
+    if (!p) {
+        return -1;
+    }
+    *arr = p;
+    *cap = cap2;
+    return 0;
+}
+
+/**
+ * @brief Queue a connection for end-of-tick flushing/closing (once).
+ */
+static void rb_server_touch(RBServer *s, RBConn *c) {
+    if (c->touched) {
+        return;
+    }
+    if (rb_server_reserve((void **)&s->touched, &s->touched_cap,
+                          s->touched_len + 1, sizeof(*s->touched)) < 0) {
+        // Can't track it: drop the client rather than leak it
+        c->closing = 1;
+        return;
+    }
+    c->touched = 1;
+    s->touched[s->touched_len++] = c;
+}
+
+/**
+ * @brief Reserve room for len more bytes of responses on c.
+ *
+ * @return Pointer to the reserved bytes, or NULL (c is then closed).
+ */
+static unsigned char *rb_server_out_reserve(RBConn *c, size_t len) {
+    if (rb_server_reserve((void **)&c->out, &c->out_cap, c->out_len + len,
+                          1) < 0) {
+        c->closing = 1;
+        return NULL;
+    }
+    return c->out + c->out_len;
+}
+
+/**
+ * @brief Append a response without payload to c.
+ */
+static void rb_server_reply(RBServer *s, RBConn *c, uint8_t op,
+                            uint8_t status) {
+    if (c->closing) {
+        return;
+    }
+    unsigned char *p = rb_server_out_reserve(c, sizeof(RBResponse));
+    if (p) {
+        RBResponse r = {op, status, 0, 0};
+        memcpy(p, &r, sizeof(r));
+        c->out_len += sizeof(r);
+    }
+    rb_server_touch(s, c);
+}
+
+/**
+ * @struct RBRangeReply
+ * @brief Collects range keys straight into a connection's out buffer.
+ */
+typedef struct {
+    unsigned char *keys; // Where the next key goes.
+    uint32_t count;      // Keys written so far.
+    int truncated;       // More than RB_RANGE_MAX keys in range.
+} RBRangeReply;
+
+static int rb_server_range_visit(RBNode *n, void *ctx) {
+    RBRangeReply *r = ctx;
+    if (r->count == RB_RANGE_MAX) {
+        r->truncated = 1;
+        return 1; // Stop the walk
+    }
+    int32_t key = n->key;
+    memcpy(r->keys + (size_t)r->count * sizeof(key), &key, sizeof(key));
+    r->count++;
+    return 0;
+}
+
+/**
+ * @brief Answer a range request: header, then up to RB_RANGE_MAX keys.
+ */
+static void rb_server_range(RBServer *s, RBConn *c, const RBRequest *req) {
+    if (c->closing) {
+        return;
+    }
+    size_t most = sizeof(RBResponse) + RB_RANGE_MAX * sizeof(int32_t);
+    unsigned char *p = rb_server_out_reserve(c, most);
+    if (p) {
+        RBRangeReply r = {p + sizeof(RBResponse), 0, 0};
+        rb_tree_range(s->t, req->key, req->key2, rb_server_range_visit, &r);
+
+        RBResponse hdr = {RB_REQ_RANGE,
+                          r.truncated ? RB_STATUS_TRUNCATED : RB_STATUS_OK, 0,
+                          r.count};
+        memcpy(p, &hdr, sizeof(hdr));
+        c->out_len += sizeof(hdr) + (size_t)r.count * sizeof(int32_t);
+    }
+    rb_server_touch(s, c);
+}
+
+/**
+ * @brief Answer a run of consecutive searches with one batched lookup.
+ */
+static void rb_server_search_run(RBServer *s, RBPending *run, size_t n) {
+    if (rb_server_reserve((void **)&s->keys, &s->keys_cap, n,
+                          sizeof(*s->keys)) < 0 ||
+        rb_server_reserve((void **)&s->found, &s->found_cap, n,
+                          sizeof(*s->found)) < 0) {
+        // Fall back to one lookup at a time
+        for (size_t i = 0; i < n; i++) {
+            RBNode *x = rb_tree_search(s->t, run[i].req.key);
+            rb_server_reply(s, run[i].conn, RB_REQ_SEARCH,
+                            x != s->t->nil ? RB_STATUS_OK
+                                           : RB_STATUS_NOT_FOUND);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        s->keys[i] = run[i].req.key;
+    }
+    rb_tree_search_batch(s->t, s->keys, n, s->found);
+    for (size_t i = 0; i < n; i++) {
+        rb_server_reply(s, run[i].conn, RB_REQ_SEARCH,
+                        s->found[i] != s->t->nil ? RB_STATUS_OK
+                                                 : RB_STATUS_NOT_FOUND);
+    }
+}
+
+/**
+ * @brief Apply every request of this tick to the tree, in arrival order.
+ *
+ *        Requests of clients that already hung up are still applied;
+ *        only their responses are dropped.
+ */
+static void rb_server_apply_batch(RBServer *s) {
+    RBTree *t = s->t;
+    size_t i = 0;
+    while (i < s->batch_len) {
+        RBPending *p = &s->batch[i];
+
+        if (p->req.op == RB_REQ_SEARCH) {
+            // Searches commute with each other: look up the whole run
+            size_t j = i + 1;
+            while (j < s->batch_len && s->batch[j].req.op == RB_REQ_SEARCH) {
+                j++;
+            }
+            rb_server_search_run(s, p, j - i);
+            i = j;
+            continue;
+        }
+
+        switch (p->req.op) {
+        case RB_REQ_INSERT:
+            rb_tree_insert(t, p->req.key);
+            rb_server_reply(s, p->conn, RB_REQ_INSERT, RB_STATUS_OK);
+            break;
+        case RB_REQ_DELETE:
+            rb_server_reply(s, p->conn, RB_REQ_DELETE,
+                            rb_tree_delete(t, p->req.key)
+                                ? RB_STATUS_OK
+                                : RB_STATUS_NOT_FOUND);
+            break;
+        case RB_REQ_RANGE:
+            rb_server_range(s, p->conn, &p->req);
+            break;
+        default:
+            rb_server_reply(s, p->conn, p->req.op, RB_STATUS_BAD_REQUEST);
+            break;
+        }
+        i++;
+    }
+    s->batch_len = 0;
+}
+
+/**
+ * @brief Largest response a request can produce.
+ */
+static size_t rb_server_reply_size(const RBRequest *req) {
+    size_t len = sizeof(RBResponse);
+    if (req->op == RB_REQ_RANGE) {
+        len += RB_RANGE_MAX * sizeof(int32_t);
+    }
+    return len;
+}
+
+/**
+ * @brief Queue c's buffered frames into this tick's batch.
+ *
+ *        Stops once the unsent output plus the most the queued requests
+ *        can add reaches RB_SERVER_OUT_HIGH; the remaining frames stay
+ *        in c->in for a later tick.
+ */
+static void rb_server_parse(RBServer *s, RBConn *c) {
+    size_t used = 0;
+    while (!c->closing && c->in_len - used >= sizeof(RBRequest) &&
+           c->out_len - c->out_off + c->out_promised < RB_SERVER_OUT_HIGH) {
+        if (rb_server_reserve((void **)&s->batch, &s->batch_cap,
+                              s->batch_len + 1, sizeof(*s->batch)) < 0) {
+            c->closing = 1;
+            break;
+        }
+        RBPending *p = &s->batch[s->batch_len++];
+        p->conn = c;
+        memcpy(&p->req, c->in + used, sizeof(RBRequest));
+        c->out_promised += rb_server_reply_size(&p->req);
+        used += sizeof(RBRequest);
+    }
+    memmove(c->in, c->in + used, c->in_len - used);
+    c->in_len -= used;
+    rb_server_touch(s, c);
+}
+
+/**
+ * @brief Read once from c, then queue complete frames.
+ *
+ *        One read per tick keeps a fast client from filling the whole
+ *        tick; epoll is level-triggered, so anything left in the socket
+ *        is reported again next tick.  EOF only means no more requests:
+ *        the ones already read are still answered, and c is closed once
+ *        its output has drained.
+ */
+static void rb_server_read(RBServer *s, RBConn *c) {
+    while (!c->closing && !c->eof && c->in_len < RB_SERVER_IN_SZ) {
+        ssize_t n = read(c->fd, c->in + c->in_len, RB_SERVER_IN_SZ - c->in_len);
+        if (n == 0) {
+            c->eof = 1; // Peer shut down its sending side
+        } else if (n > 0) {
+            c->in_len += (size_t)n;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            c->closing = 1;
+        }
+        break;
+    }
+    rb_server_parse(s, c);
+}
+
+/**
+ * @brief Remember that c still holds frames to parse next tick.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+static int rb_server_carry(RBServer *s, RBConn *c) {
+    if (rb_server_reserve((void **)&s->carry, &s->carry_cap,
+                          s->carry_len + 1, sizeof(*s->carry)) < 0) {
+        return -1;
+    }
+    s->carry[s->carry_len++] = c;
+    return 0;
+}
+
+/**
+ * @brief Send as much of c's pending output as the socket takes.
+ */
+static void rb_server_flush(RBConn *c) {
+    while (!c->closing && c->out_off < c->out_len) {
+        ssize_t n = send(c->fd, c->out + c->out_off, c->out_len - c->out_off,
+                         MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                c->closing = 1;
+            }
+            return;
+        }
+        c->out_off += (size_t)n;
+    }
+    if (c->out_off == c->out_len) {
+        c->out_off = 0;
+        c->out_len = 0;
+    }
+}
+
+/**
+ * @brief Close and free a connection.
+ */
+static void rb_server_close(RBServer *s, RBConn *c) {
+    epoll_ctl(s->epfd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    if (c->prev) {
+        c->prev->next = c->next;
+    } else {
+        s->conns = c->next;
+    }
+    if (c->next) {
+        c->next->prev = c->prev;
+    }
+    free(c->out);
+    free(c);
+}
+
+/**
+ * @brief End of tick for one connection: flush, then close it or
+ *        update its epoll interest.
+ *
+ *        Reading is paused while too many responses are unsent, and
+ *        writability is only watched while output is pending.  A
+ *        half-closed client is closed once everything has been sent.
+ *        Frames held back by the output limit are parsed next tick if
+ *        there is room again, else when the socket becomes writable.
+ */
+static void rb_server_settle(RBServer *s, RBConn *c) {
+    c->touched = 0;
+    c->out_promised = 0; // Every queued request has been answered
+    rb_server_flush(c);
+    size_t backlog = c->out_len - c->out_off;
+    int held = c->in_len >= sizeof(RBRequest);
+    if (c->closing || (c->eof && backlog == 0 && !held)) {
+        rb_server_close(s, c);
+        return;
+    }
+
+    uint32_t want = 0;
+    if (!c->eof && backlog < RB_SERVER_OUT_HIGH &&
+        c->in_len < RB_SERVER_IN_SZ) {
+        want |= EPOLLIN;
+    }
+    if (backlog > 0) {
+        want |= EPOLLOUT;
+    }
+    if (want != c->events) {
+        struct epoll_event ev = {.events = want, .data.ptr = c};
+        if (epoll_ctl(s->epfd, EPOLL_CTL_MOD, c->fd, &ev) < 0) {
+            rb_server_close(s, c);
+            return;
+        }
+        c->events = want;
+    }
+
+    // Only a connection that stays open may be carried into next tick
+    if (held && backlog < RB_SERVER_OUT_HIGH && rb_server_carry(s, c) < 0) {
+        rb_server_close(s, c);
+    }
+}
+
+/**
+ * @brief Accept and immediately close one pending client.
+ *
+ *        Used when out of descriptors: the listening socket is
+ *        level-triggered, so leaving the client queued would wake
+ *        epoll_wait() at once, every tick, until a descriptor frees up.
+ *        The spare descriptor is given up for a moment to make room.
+ *
+ * @return 0 if a client was dropped, -1 if none could be.
+ */
+static int rb_server_reject(RBServer *s) {
+    if (s->spare_fd < 0) {
+        return -1;
+    }
+    close(s->spare_fd);
+    int fd = accept4(s->lfd, NULL, NULL, SOCK_CLOEXEC);
+    if (fd >= 0) {
+        close(fd);
+    }
+    s->spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    return fd >= 0 ? 0 : -1;
+}
+
+/**
+ * @brief Accept every pending client.
+ */
+static void rb_server_accept(RBServer *s) {
+    for (;;) {
+        int fd = accept4(s->lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EMFILE || errno == ENFILE) &&
+                rb_server_reject(s) == 0) {
+                continue;
+            }
+            return; // EAGAIN, or nothing could be done: retry next tick
+        }
+
+        RBConn *c = calloc(1, sizeof(RBConn));
+        if (!c) {
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->events = EPOLLIN;
+
+        struct epoll_event ev = {.events = EPOLLIN, .data.ptr = c};
+        if (epoll_ctl(s->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            free(c);
+            continue;
+        }
+        c->next = s->conns;
+        if (s->conns) {
+            s->conns->prev = c;
+        }
+        s->conns = c;
+    }
+}
+
+/**
+ * @brief Create, bind and listen on a non-blocking Unix socket.
+ *
+ * @return The socket, or -1 (with a message on stderr).
+ */
+static int rb_server_listen(const char *path) {
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        close(fd);
+        return -1;
+    }
+    if (listen(fd, SOMAXCONN) < 0) {
+        perror("listen");
+        close(fd);
+        unlink(path);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Serve a Red-Black Tree on a Unix domain socket.
+ *
+ *        1) Set up the listening socket, epoll and signal handlers.
+ *        2) Each tick: wait for events, accept clients, read once from
+ *           each readable client and parse its requests into one
+ *           batch, along with frames held back in earlier ticks.
+ *        3) Apply the batch to the tree.
+ *        4) Flush responses, close finished clients.
+ *        5) On SIGINT/SIGTERM, close everything and remove the socket.
+ *
+ * @param t     The tree to serve.
+ * @param path  Filesystem path of the listening socket.
+ *
+ * @return 0 after a clean shutdown, -1 on setup failure.
+ */
+int rb_server_run(RBTree *t, const char *path) {
+    // 1) Set up
+    RBServer s = {.t = t, .epfd = -1, .lfd = -1, .spare_fd = -1};
+    s.lfd = rb_server_listen(path);
+    if (s.lfd < 0) {
+        return -1;
+    }
+    s.epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (s.epfd < 0) {
+        perror("epoll_create1");
+        close(s.lfd);
+        unlink(path);
+        return -1;
+    }
+    struct epoll_event lev = {.events = EPOLLIN, .data.ptr = NULL};
+    if (epoll_ctl(s.epfd, EPOLL_CTL_ADD, s.lfd, &lev) < 0) {
+        perror("epoll_ctl");
+        close(s.epfd);
+        close(s.lfd);
+        unlink(path);
+        return -1;
+    }
+
+    // Held back for rb_server_reject(); the server runs without it too
+    s.spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+    // No SA_RESTART, so a signal interrupts epoll_wait()
+    struct sigaction sa = {.sa_handler = rb_server_on_signal};
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    rb_server_stop = 0;
+
+    struct epoll_event events[RB_SERVER_MAX_EVENTS];
+    while (!rb_server_stop) {
+        // 2) Gather this tick's requests; don't block while frames
+        //    are held back
+        int n = epoll_wait(s.epfd, events, RB_SERVER_MAX_EVENTS,
+                           s.carry_len ? 0 : -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            break;
+        }
+        for (size_t i = 0; i < s.carry_len; i++) {
+            rb_server_parse(&s, s.carry[i]);
+        }
+        s.carry_len = 0;
+        for (int i = 0; i < n; i++) {
+            RBConn *c = events[i].data.ptr;
+            if (!c) {
+                rb_server_accept(&s);
+            } else if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                rb_server_read(&s, c);
+            } else {
+                // EPOLLOUT only: flush, and parse frames held back
+                rb_server_parse(&s, c);
+            }
+        }
+
+        // 3) Apply them as one batch
+        rb_server_apply_batch(&s);
+
+        // 4) Write back
+        for (size_t i = 0; i < s.touched_len; i++) {
+            rb_server_settle(&s, s.touched[i]);
+        }
+        s.touched_len = 0;
+    }
+
+    // 5) Shut down
+    while (s.conns) {
+        rb_server_close(&s, s.conns);
+    }
+    if (s.spare_fd >= 0) {
+        close(s.spare_fd);
+    }
+    close(s.epfd);
+    close(s.lfd);
+    unlink(path);
+    free(s.batch);
+    free(s.touched);
+    free(s.carry);
+    free(s.keys);
+    free(s.found);
+    return 0;
+}
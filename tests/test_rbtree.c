@@ -1,8 +1,50 @@
 // tests/test_rbtree.c
+#define _GNU_SOURCE
+
 #include "../include/auxiliary.h"
+#include "../include/interval_tree.h"
+#include "../include/rb_packed.h"
+#include "../include/rb_protocol.h"
+#include "../include/rb_stats.h"
 #include "../include/rb_tree.h"
+#include "../include/rb_tree_inline.h"
+#include "../include/rb_tree_td.h"
+#include "../include/server.h"
 #include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Check the red-black properties of a top-down subtree.
+ *
+ * Asserts BST order within (lo, hi), no red node with a red child, and
+ * equal black height on every path.
+ *
+ * @return The black height of the subtree.
+ */
+static int check_td_subtree(RBTDTree *t, RBTDNode *n, int lo, int hi) {
+    if (n == t->nil) {
+        return 1;
+    }
+    assert(n->key >= lo && n->key <= hi);
+    if (n->color == RED) {
+        assert(n->child[0]->color == BLACK && n->child[1]->color == BLACK);
+    }
+    int lh = check_td_subtree(t, n->child[0], lo, n->key);
+    int rh = check_td_subtree(t, n->child[1], n->key, hi);
+    assert(lh == rh);
+    return lh + (n->color == BLACK);
+}
 
 static void test_insert_search_delete(void) {
     RBTree *t = rb_tree_create();
@@ -37,8 +79,651 @@ static void test_insert_search_delete(void) {
     rb_tree_destroy(t);
 }
 
+static void test_top_down(void) {
+    RBTDTree *t = rb_td_tree_create();
+    assert(t);
+
+    // keys 0..N-1 in a scrambled order (7919 is coprime with N)
+    enum { N = 2000 };
+    static int present[N];
+    for (int i = 0; i < N; i++) {
+        int key = (i * 7919) % N;
+        rb_td_tree_insert(t, key);
+        present[key] = 1;
+        assert(t->root->color == BLACK);
+    }
+    check_td_subtree(t, t->root, INT_MIN, INT_MAX);
+
+    // delete every third key, plus some that were never inserted
+    for (int key = 0; key < N + 10; key += 3) {
+        rb_td_tree_delete(t, key);
+        if (key < N) {
+            present[key] = 0;
+        }
+        check_td_subtree(t, t->root, INT_MIN, INT_MAX);
+    }
+
+    for (int key = 0; key < N; key++) {
+        RBTDNode *n = rb_td_tree_search(t, key);
+        assert((n != t->nil) == present[key]);
+    }
+
+    // duplicates: both copies stored, removed one at a time
+    rb_td_tree_insert(t, 3);
+    rb_td_tree_insert(t, 3);
+    rb_td_tree_delete(t, 3);
+    assert(rb_td_tree_search(t, 3) != t->nil);
+    rb_td_tree_delete(t, 3);
+    assert(rb_td_tree_search(t, 3) == t->nil);
+
+    // drain completely
+    for (int key = 0; key < N; key++) {
+        rb_td_tree_delete(t, key);
+    }
+    assert(t->root == t->nil);
+
+    rb_td_tree_destroy(t);
+}
+
+/**
+ * @brief Check the red-black properties of a (bottom-up) subtree.
+ *
+ * Asserts BST order within [lo, hi], parent links, no red node with a
+ * red child, and equal black height on every path.
+ *
+ * @return The black height of the subtree.
+ */
+static int check_rb_subtree(RBTree *t, RBNode *n, int lo, int hi) {
+    if (n == t->nil) {
+        return 1;
+    }
+    assert(n->key >= lo && n->key <= hi);
+    assert(n->left == t->nil || n->left->parent == n);
+    assert(n->right == t->nil || n->right->parent == n);
+    if (n->color == RED) {
+        assert(n->left->color == BLACK && n->right->color == BLACK);
+    }
+    int lh = check_rb_subtree(t, n->left, lo, n->key);
+    int rh = check_rb_subtree(t, n->right, n->key, hi);
+    assert(lh == rh);
+    return lh + (n->color == BLACK);
+}
+
+/**
+ * @brief Check that every node's max equals the largest hi below it.
+ *
+ * @return The max endpoint of the subtree (INT_MIN if empty).
+ */
+static int check_interval_max(RBTree *t, RBNode *n) {
+    if (n == t->nil) {
+        return INT_MIN;
+    }
+    IntervalNode *in = (IntervalNode *)n;
+    int max = in->hi;
+    int l = check_interval_max(t, n->left);
+    int r = check_interval_max(t, n->right);
+    if (l > max) {
+        max = l;
+    }
+    if (r > max) {
+        max = r;
+    }
+    assert(in->max == max);
+    return max;
+}
+
+static void test_interval_tree(void) {
+    RBTree *t = interval_tree_create();
+    assert(t);
+
+    enum { N = 500 };
+    static int lo[N], hi[N], live[N];
+    for (int i = 0; i < N; i++) {
+        lo[i] = (i * 37) % 1000;
+        hi[i] = lo[i] + (i * 13) % 50;
+        interval_tree_insert(t, lo[i], hi[i]);
+        live[i] = 1;
+    }
+    check_interval_max(t, t->root);
+
+    // remove every other interval
+    for (int i = 0; i < N; i += 2) {
+        interval_tree_delete(t, lo[i], hi[i]);
+        live[i] = 0;
+        check_interval_max(t, t->root);
+    }
+
+    // compare overlap and stabbing queries with a brute-force scan
+    for (int q = -10; q < 1060; q += 7) {
+        size_t expect_overlap = 0, expect_stab = 0;
+        for (int i = 0; i < N; i++) {
+            if (!live[i]) {
+                continue;
+            }
+            expect_overlap += lo[i] <= q + 20 && hi[i] >= q;
+            expect_stab += lo[i] <= q && hi[i] >= q;
+        }
+        assert(interval_tree_overlap(t, q, q + 20, NULL, NULL) ==
+               expect_overlap);
+        assert(interval_tree_stab(t, q, NULL, NULL) == expect_stab);
+    }
+
+    rb_tree_destroy(t);
+
+    // many intervals per low endpoint: rotations spread equal keys on
+    // both sides, so delete must search both subtrees on a key match
+    t = interval_tree_create();
+    assert(t);
+    enum { LOWS = 10, PER = 30, M = LOWS * PER };
+    for (int i = 0; i < M; i++) {
+        int k = (i * 7) % M; // scrambled insert order
+        lo[k] = (k % LOWS) * 10;
+        hi[k] = lo[k] + 1 + (k / LOWS) * 3;
+        interval_tree_insert(t, lo[k], hi[k]);
+        live[k] = 1;
+    }
+    check_interval_max(t, t->root);
+
+    // a shared low endpoint with a missing hi deletes nothing
+    interval_tree_delete(t, 0, 2);
+    assert(t->size == M);
+
+    for (int i = 0; i < M; i++) {
+        int k = (i * 113) % M; // mixed order: lows and lengths interleave
+        interval_tree_delete(t, lo[k], hi[k]);
+        live[k] = 0;
+        assert(t->size == (size_t)(M - i - 1));
+        check_interval_max(t, t->root);
+        for (int q = 0; q < 200; q += 4) {
+            size_t expect = 0;
+            for (int j = 0; j < M; j++) {
+                expect += live[j] && lo[j] <= q + 2 && hi[j] >= q;
+            }
+            assert(interval_tree_overlap(t, q, q + 2, NULL, NULL) == expect);
+        }
+    }
+    rb_tree_destroy(t);
+}
+
+static void test_search_batch(void) {
+    RBTree *t = rb_tree_create();
+    assert(t);
+
+    for (int key = 0; key < 1000; key += 2) {
+        rb_tree_insert(t, key);
+    }
+
+    // not a multiple of RB_SEARCH_BATCH, and half of the keys are missing
+    enum { N = 3 * RB_SEARCH_BATCH + 5 };
+    int keys[N];
+    RBNode *out[N];
+    for (int i = 0; i < N; i++) {
+        keys[i] = (i * 31) % 1000;
+    }
+    rb_tree_search_batch(t, keys, N, out);
+    for (int i = 0; i < N; i++) {
+        assert(out[i] == rb_tree_search(t, keys[i]));
+    }
+
+    rb_tree_destroy(t);
+}
+
+static void test_inline(void) {
+    RBTree *t = interval_tree_create();
+    assert(t);
+
+    for (int i = 0; i < 200; i++) {
+        interval_tree_insert(t, (i * 37) % 400, (i * 37) % 400 + i % 50);
+    }
+    for (int key = -1; key < 401; key++) {
+        assert(rb_tree_search_inline(t, key) == rb_tree_search(t, key));
+    }
+
+    // rotate the root both ways and back: order and summaries must hold
+    RBNode *root = t->root;
+    rb_tree_left_rotate_inline(t, root);
+    assert(t->root == root->parent && t->root->left == root);
+    check_interval_max(t, t->root);
+    rb_tree_right_rotate_inline(t, t->root);
+    assert(t->root == root);
+    check_interval_max(t, t->root);
+
+    rb_tree_right_rotate_inline(t, root);
+    assert(t->root == root->parent && t->root->right == root);
+    check_interval_max(t, t->root);
+    rb_tree_left_rotate_inline(t, t->root);
+    assert(t->root == root);
+    check_interval_max(t, t->root);
+    check_rb_subtree(t, t->root, INT_MIN, INT_MAX);
+
+    rb_tree_destroy(t);
+}
+
+/**
+ * @brief Count the nodes of a subtree stored inside region r.
+ */
+static size_t count_in_region(RBTree *t, RBNode *n, RBRegion *r) {
+    if (n == t->nil) {
+        return 0;
+    }
+    unsigned char *p = (unsigned char *)n;
+    size_t self = p >= r->base && p < r->base + r->cap * t->node_size;
+    return self + count_in_region(t, n->left, r) +
+           count_in_region(t, n->right, r);
+}
+
+/**
+ * @brief Total slots of every compaction region of t.
+ */
+static size_t region_cap(RBTree *t) {
+    size_t cap = 0;
+    for (RBRegion *r = t->regions; r; r = r->next) {
+        cap += r->cap;
+    }
+    return cap;
+}
+
+static void test_compact(void) {
+    RBTree *t = rb_tree_create();
+    assert(t);
+
+    enum { N = 1000 };
+    for (int i = 0; i < N; i++) {
+        rb_tree_insert(t, (i * 7919) % N);
+    }
+    for (int key = 0; key < N; key += 4) {
+        rb_tree_delete(t, key);
+    }
+    assert(t->size == N - N / 4);
+
+    // incremental pass in small slices
+    int steps = 0, done;
+    while ((done = rb_tree_compact_step(t, 10)) == 0) {
+        steps++;
+    }
+    assert(done == 1 && steps > 10);
+    check_rb_subtree(t, t->root, INT_MIN, INT_MAX);
+
+    // one region holds every node, with the root in slot 0
+    assert(t->regions && !t->regions->next);
+    assert((unsigned char *)t->root == t->regions->base);
+    assert(count_in_region(t, t->root, t->regions) == t->size);
+
+    // a mutation doesn't stop a running pass; a second pass picks up
+    // the new node
+    assert(rb_tree_compact_step(t, 10) == 0);
+    rb_tree_insert(t, N + 1);
+    rb_tree_delete(t, 1);
+    assert(rb_tree_compact(t) == 0);
+    check_rb_subtree(t, t->root, INT_MIN, INT_MAX);
+    assert(rb_tree_compact(t) == 0);
+    assert(count_in_region(t, t->root, t->regions) == t->size);
+    assert(!t->regions->next); // older regions were released
+
+    for (int key = 0; key < N; key++) {
+        RBNode *n = rb_tree_search(t, key);
+        assert((n != t->nil) == (key % 4 != 0 && key != 1));
+    }
+    rb_tree_destroy(t);
+
+    // augmented nodes are moved whole
+    t = interval_tree_create();
+    assert(t);
+    for (int i = 0; i < 200; i++) {
+        interval_tree_insert(t, i, i + (i * 13) % 50);
+    }
+    assert(rb_tree_compact(t) == 0);
+    check_interval_max(t, t->root);
+    interval_tree_delete(t, 5, 5 + 65 % 50);
+    assert(interval_tree_stab(t, 0, NULL, NULL) == 1);
+    rb_tree_destroy(t);
+}
+
+static void test_compact_live(void) {
+    RBTree *t = rb_tree_create();
+    assert(t);
+
+    enum { N = 20000, BUDGET = 50 };
+    static int present[3 * N];
+    for (int i = 0; i < N; i++) {
+        int key = (i * 7919) % N;
+        rb_tree_insert(t, key);
+        present[key] = 1;
+    }
+
+    // an insert and a delete between every slice: each pass still
+    // finishes within its bounded number of slices (moves, then old
+    // slots swept), and regions never hold more than two trees' worth
+    int next = N, victim = 0;
+    for (int pass = 0; pass < 8; pass++) {
+        size_t limit = (t->size + region_cap(t)) / BUDGET + 2;
+        size_t slices = 0;
+        int done;
+        while ((done = rb_tree_compact_step(t, BUDGET)) == 0) {
+            slices++;
+            assert(slices <= limit);
+            assert(region_cap(t) <= 2 * t->size);
+            rb_tree_insert(t, next);
+            present[next++] = 1;
+            victim = (victim + 7919) % next;
+            present[victim] -= rb_tree_delete(t, victim);
+        }
+        assert(done == 1 && slices > 10);
+        assert(t->regions && !t->regions->next);
+        check_rb_subtree(t, t->root, INT_MIN, INT_MAX);
+    }
+
+    size_t size = 0;
+    for (int key = 0; key < next; key++) {
+        assert((rb_tree_search(t, key) != t->nil) == present[key]);
+        size += present[key];
+    }
+    assert(size == t->size);
+
+    // nearly every node ended up in the last pass's region
+    assert(count_in_region(t, t->root, t->regions) > t->size / 10 * 9);
+    rb_tree_destroy(t);
+}
+
+static void test_histogram(void) {
+    RBHistogram h = {0};
+    assert(rb_histogram_percentile(&h, 50.0) == 0);
+
+    // 1..1000: small values are exact, large ones within a bucket
+    for (uint64_t v = 1; v <= 1000; v++) {
+        rb_histogram_record(&h, v);
+    }
+    assert(h.total == 1000 && h.max == 1000);
+    assert(rb_histogram_percentile(&h, 0.1) == 1);
+    assert(rb_histogram_percentile(&h, 100.0) == 1000);
+
+    uint64_t p50 = rb_histogram_percentile(&h, 50.0);
+    uint64_t p99 = rb_histogram_percentile(&h, 99.0);
+    assert(p50 >= 500 && p50 <= 500 + 500 / 8);
+    assert(p99 >= 990 && p99 <= 1000);
+
+    // one huge outlier lands in the tail, not the median
+    rb_histogram_record(&h, (uint64_t)1 << 40);
+    assert(rb_histogram_percentile(&h, 50.0) == p50);
+    assert(rb_histogram_percentile(&h, 100.0) == (uint64_t)1 << 40);
+}
+
+#ifdef RB_TREE_STATS
+static void count_event(RBTree *t, RBTraceEvent ev, RBNode *n, void *ctx) {
+    (void)t;
+    (void)n;
+    ((int *)ctx)[ev]++;
+}
+
+static void test_stats_and_trace(void) {
+    RBTree *t = rb_tree_create();
+    assert(t);
+    assert(rb_tree_stats_enable(t) == 0);
+
+    int seen[RB_TRACE_EVENT_COUNT] = {0};
+    rb_tree_set_trace(t, count_event, seen);
+
+    // ascending inserts force rotations
+    for (int key = 0; key < 100; key++) {
+        rb_tree_insert(t, key);
+    }
+    for (int key = 0; key < 100; key += 2) {
+        rb_tree_search(t, key);
+        rb_tree_delete(t, key);
+    }
+
+    assert(t->stats->latency[RB_OP_INSERT].total == 100);
+    assert(t->stats->latency[RB_OP_DELETE].total == 50);
+    assert(t->stats->latency[RB_OP_SEARCH].total == 50);
+
+    // a batched lookup counts once per key, a delete never as a search
+    int keys[20];
+    RBNode *out[20];
+    for (int i = 0; i < 20; i++) {
+        keys[i] = i;
+    }
+    rb_tree_search_batch(t, keys, 20, out);
+    assert(rb_tree_delete(t, 1) == 1);
+    assert(rb_tree_delete(t, 1) == 0);
+    assert(t->stats->latency[RB_OP_SEARCH].total == 70);
+    assert(t->stats->latency[RB_OP_DELETE].total == 52);
+    assert(seen[RB_TRACE_LEFT_ROTATE] > 0);
+    for (int ev = 0; ev < RB_TRACE_EVENT_COUNT; ev++) {
+        assert((uint64_t)seen[ev] == t->stats->events[ev]);
+    }
+
+    rb_tree_destroy(t);
+}
+#endif
+
+static int collect_key(int key, void *ctx) {
+    int **out = ctx;
+    *(*out)++ = key;
+    return 0;
+}
+
+static int collect_node(RBNode *n, void *ctx) {
+    return collect_key(n->key, ctx);
+}
+
+static void test_packed(void) {
+    RBTree *t = rb_tree_create();
+    assert(t);
+
+    // empty tree
+    RBPacked *p = rb_packed_export(t);
+    assert(p && p->count == 0);
+    assert(!rb_packed_contains(p, 0));
+    assert(rb_packed_range(p, INT_MIN, INT_MAX, NULL, NULL) == 0);
+    rb_packed_destroy(p);
+
+    // dense runs, wide gaps, duplicates and both extremes
+    enum { N = 1000 };
+    for (int i = 0; i < N; i++) {
+        rb_tree_insert(t, (i % 3 == 0) ? i * 1000003 : i);
+    }
+    for (int i = 0; i < 300; i++) {
+        rb_tree_insert(t, 42); // a run longer than a block
+    }
+    rb_tree_insert(t, INT_MIN);
+    rb_tree_insert(t, INT_MAX);
+
+    p = rb_packed_export(t);
+    assert(p && p->count == t->size);
+    assert(rb_packed_bytes(p) < t->size * sizeof(RBNode));
+
+    for (int i = -5; i < N + 5; i++) {
+        int keys[] = {i, i * 1000003};
+        for (int j = 0; j < 2; j++) {
+            int expect = rb_tree_search(t, keys[j]) != t->nil;
+            assert(rb_packed_contains(p, keys[j]) == expect);
+        }
+    }
+    assert(rb_packed_contains(p, INT_MIN) && rb_packed_contains(p, INT_MAX));
+
+    // ranges match the tree's, key for key
+    static int got[N + 400], want[N + 400];
+    int ranges[][2] = {{INT_MIN, INT_MAX}, {40, 44}, {42, 42},
+                       {500, 3000000}, {-10, -1}, {7, 3}};
+    for (size_t r = 0; r < sizeof(ranges) / sizeof(*ranges); r++) {
+        int *g = got, *w = want;
+        size_t ng = rb_packed_range(p, ranges[r][0], ranges[r][1],
+                                    collect_key, &g);
+        size_t nw = rb_tree_range(t, ranges[r][0], ranges[r][1],
+                                  collect_node, &w);
+        assert(ng == nw && (size_t)(g - got) == ng);
+        assert(memcmp(got, want, ng * sizeof(int)) == 0);
+    }
+
+    rb_packed_destroy(p);
+    rb_tree_destroy(t);
+}
+
+static void read_exact(int fd, void *buf, size_t len) {
+    unsigned char *p = buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        assert(n > 0);
+        p += n;
+        len -= (size_t)n;
+    }
+}
+
+static void test_server(void) {
+    char path[64];
+    snprintf(path, sizeof path, "/tmp/rbtree_test_%d.sock", (int)getpid());
+
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        // few descriptors, so the last part can run the server out
+        struct rlimit lim = {32, 32};
+        setrlimit(RLIMIT_NOFILE, &lim);
+        RBTree *t = rb_tree_create();
+        int rc = t ? rb_server_run(t, path) : -1;
+        rb_tree_destroy(t);
+        _exit(rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    // wait for the server to come up
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    strcpy(addr.sun_path, path);
+    int fd = -1;
+    for (int tries = 0; tries < 200 && fd < 0; tries++) {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        assert(fd >= 0);
+        if (connect(fd, (struct sockaddr *)&addr, sizeof addr) < 0) {
+            close(fd);
+            fd = -1;
+            nanosleep(&(struct timespec){0, 10 * 1000 * 1000}, NULL);
+        }
+    }
+    assert(fd >= 0);
+
+    // one pipelined write holding every request
+    RBRequest reqs[] = {
+        {RB_REQ_INSERT, {0}, 30, 0}, {RB_REQ_INSERT, {0}, 10, 0},
+        {RB_REQ_INSERT, {0}, 20, 0}, {RB_REQ_SEARCH, {0}, 20, 0},
+        {RB_REQ_SEARCH, {0}, 25, 0}, {RB_REQ_DELETE, {0}, 20, 0},
+        {RB_REQ_DELETE, {0}, 20, 0}, {RB_REQ_SEARCH, {0}, 20, 0},
+        {RB_REQ_RANGE, {0}, 0, 100}, {99, {0}, 0, 0},
+    };
+    uint8_t expect[] = {RB_STATUS_OK,        RB_STATUS_OK,
+                        RB_STATUS_OK,        RB_STATUS_OK,
+                        RB_STATUS_NOT_FOUND, RB_STATUS_OK,
+                        RB_STATUS_NOT_FOUND, RB_STATUS_NOT_FOUND,
+                        RB_STATUS_OK,        RB_STATUS_BAD_REQUEST};
+    assert(write(fd, reqs, sizeof reqs) == (ssize_t)sizeof reqs);
+    // half-close: no more requests, but every response must still arrive
+    assert(shutdown(fd, SHUT_WR) == 0);
+
+    for (size_t i = 0; i < sizeof(reqs) / sizeof(*reqs); i++) {
+        RBResponse r;
+        read_exact(fd, &r, sizeof r);
+        assert(r.op == reqs[i].op && r.status == expect[i]);
+        if (r.op == RB_REQ_RANGE) {
+            int32_t keys[2];
+            assert(r.count == 2);
+            read_exact(fd, keys, sizeof keys);
+            assert(keys[0] == 10 && keys[1] == 30);
+        } else {
+            assert(r.count == 0);
+        }
+    }
+    char extra;
+    assert(read(fd, &extra, 1) == 0); // closed once everything was sent
+    close(fd);
+
+    // far more range output than the server buffers per client: it must
+    // hold requests back and still answer all of them, in order
+    enum { KEYS = RB_RANGE_MAX + 100, RANGES = 300 };
+    static RBRequest flood[KEYS + RANGES];
+    for (int i = 0; i < KEYS; i++) {
+        flood[i] = (RBRequest){RB_REQ_INSERT, {0}, i, 0};
+    }
+    for (int i = KEYS; i < KEYS + RANGES; i++) {
+        flood[i] = (RBRequest){RB_REQ_RANGE, {0}, 0, INT_MAX};
+    }
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert(fd >= 0);
+    assert(connect(fd, (struct sockaddr *)&addr, sizeof addr) == 0);
+    assert(write(fd, flood, sizeof flood) == (ssize_t)sizeof flood);
+    assert(shutdown(fd, SHUT_WR) == 0);
+
+    static int32_t keys[RB_RANGE_MAX];
+    for (int i = 0; i < KEYS + RANGES; i++) {
+        RBResponse r;
+        read_exact(fd, &r, sizeof r);
+        assert(r.op == flood[i].op);
+        if (r.op == RB_REQ_RANGE) {
+            // the tree also holds 10 and 30 from the first client
+            assert(r.status == RB_STATUS_TRUNCATED && r.count == RB_RANGE_MAX);
+            read_exact(fd, keys, sizeof keys);
+            assert(keys[0] == 0 && keys[RB_RANGE_MAX - 1] < KEYS);
+        }
+    }
+    assert(read(fd, &extra, 1) == 0);
+    close(fd);
+
+    // more clients than the server has descriptors: the excess ones are
+    // dropped instead of left queued, which would keep epoll_wait()
+    // returning at once and the server spinning
+    enum { CLIENTS = 48 };
+    int fds[CLIENTS];
+    for (int i = 0; i < CLIENTS; i++) {
+        fds[i] = socket(AF_UNIX, SOCK_STREAM, 0);
+        assert(fds[i] >= 0);
+        assert(connect(fds[i], (struct sockaddr *)&addr, sizeof addr) == 0);
+    }
+    nanosleep(&(struct timespec){0, 200 * 1000 * 1000}, NULL);
+    int dropped = 0, kept = -1;
+    for (int i = 0; i < CLIENTS; i++) {
+        ssize_t n = recv(fds[i], &extra, 1, MSG_DONTWAIT);
+        if (n == 0) {
+            dropped++;
+        } else {
+            assert(n < 0 && errno == EAGAIN);
+            kept = i;
+        }
+    }
+    assert(dropped > 0 && kept >= 0);
+
+    // the clients that got in are still served
+    RBRequest req = {RB_REQ_SEARCH, {0}, 10, 0};
+    RBResponse resp;
+    assert(write(fds[kept], &req, sizeof req) == (ssize_t)sizeof req);
+    read_exact(fds[kept], &resp, sizeof resp);
+    assert(resp.op == RB_REQ_SEARCH && resp.status == RB_STATUS_OK);
+    for (int i = 0; i < CLIENTS; i++) {
+        close(fds[i]);
+    }
+
+    int status;
+    struct rusage ru;
+    kill(pid, SIGTERM);
+    assert(wait4(pid, &status, 0, &ru) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    // well under the 200 ms the excess clients were left waiting
+    long cpu_us = (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000L +
+                  ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+    assert(cpu_us < 100 * 1000);
+    assert(access(path, F_OK) != 0); // socket file removed
+}
+
 int main(void) {
     test_insert_search_delete();
+    test_top_down();
+    test_interval_tree();
+    test_search_batch();
+    test_inline();
+    test_compact();
+    test_compact_live();
+    test_histogram();
+    test_server();
+    test_packed();
+#ifdef RB_TREE_STATS
+    test_stats_and_trace();
+#endif
     puts("ALL TESTS PASSED.");
     return 0;
 }